@@ -0,0 +1,600 @@
+// Microbenchmarks for the engine-independent network code. Results are written
+// as JSON so runs can be diffed.
+// Usage: network_benchmarks [--filter TEXT] [--min-time SECONDS] [--out FILE]
+#include "NetCore/NetCore.h"
+#include "RemoteUpdateQueue.cpp"
+#include "SpatialGrid.cpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace NetCore;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    template <typename T>
+    inline void DoNotOptimize(T const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    struct BenchmarkResult {
+        std::string name;
+        std::uint64_t iterations = 0;
+        double nsPerOp = 0.0;
+        double nsPerOpMin = 0.0;
+        double bytesPerOp = 0.0;
+    };
+
+    struct Options {
+        std::string filter;
+        double minTime = 0.2;
+        std::string outPath;
+    };
+
+    std::vector<BenchmarkResult> Results;
+    Options Settings;
+
+    // Calls fn(iterations) and reports the median of five timed samples. Each call
+    // of fn must perform `iterations * opsPerIteration` operations.
+    void Run(const std::string& name, std::function<void(std::uint64_t)> fn, double opsPerIteration = 1.0, double bytesPerOp = 0.0) {
+        if (!Settings.filter.empty() && name.find(Settings.filter) == std::string::npos) {
+            return;
+        }
+
+        std::uint64_t iterations = 1;
+        for (;;) {
+            auto start = Clock::now();
+            fn(iterations);
+            double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            if (elapsed >= Settings.minTime / 5 || iterations >= (1ull << 40)) {
+                break;
+            }
+            double scale = elapsed > 0.0 ? (Settings.minTime / 5) / elapsed : 10.0;
+            iterations = static_cast<std::uint64_t>(iterations * std::min(std::max(scale * 1.2, 2.0), 10.0));
+        }
+
+        std::vector<double> samples;
+        for (int i = 0; i < 5; i++) {
+            auto start = Clock::now();
+            fn(iterations);
+            double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            samples.push_back(elapsed / (iterations * opsPerIteration));
+        }
+        std::sort(samples.begin(), samples.end());
+
+        BenchmarkResult result;
+        result.name = name;
+        result.iterations = iterations;
+        result.nsPerOp = samples[samples.size() / 2];
+        result.nsPerOpMin = samples.front();
+        result.bytesPerOp = bytesPerOp;
+        Results.push_back(result);
+        std::fprintf(stderr, "%-44s %12.1f ns/op\n", name.c_str(), result.nsPerOp);
+    }
+
+    NetworkPacket StateUpdate(UpdateType type, const char* sender = "BDT_1013_BANDIT_L-NW_CASTLEMINE_TOWER_05-1") {
+        NetworkPacket packet;
+        packet.type = PacketType::PlayerStateUpdate;
+        packet.senderId = sender;
+        packet.stateUpdate.updateType = type;
+        return packet;
+    }
+
+    std::vector<std::pair<std::string, NetworkPacket>> SamplePackets() {
+        std::vector<std::pair<std::string, NetworkPacket>> packets;
+
+        NetworkPacket join;
+        join.type = PacketType::JoinGame;
+        join.senderId = "HOST";
+        join.joinGame.connectId = 12345;
+        join.joinGame.name = "FRIEND_1";
+        packets.emplace_back("JoinGame", join);
+
+        NetworkPacket disconnect;
+        disconnect.type = PacketType::PlayerDisconnect;
+        disconnect.senderId = "HOST";
+        disconnect.disconnect.name = "FRIEND_1";
+        disconnect.disconnect.hasNickname = true;
+        disconnect.disconnect.nickname = "Diego";
+        packets.emplace_back("PlayerDisconnect", disconnect);
+
+        auto init = StateUpdate(INIT_NPC, "FRIEND_1");
+        init.stateUpdate.initNpc.instanceId = 11471;
+        init.stateUpdate.initNpc.nickname = "Diego";
+        init.stateUpdate.initNpc.bodyModel = "HUM_BODY_NAKED0";
+        init.stateUpdate.initNpc.BodyTex = 9;
+        init.stateUpdate.initNpc.headModel = "HUM_HEAD_PONY";
+        init.stateUpdate.initNpc.HeadTex = 18;
+        packets.emplace_back("INIT_NPC", init);
+
+        auto pos = StateUpdate(SYNC_POS);
+        pos.stateUpdate.pos = { 1200.5f, -340.25f, 8800.0f };
+        packets.emplace_back("SYNC_POS", pos);
+
+        auto heading = StateUpdate(SYNC_HEADING);
+        heading.stateUpdate.heading.heading = 271.5f;
+        packets.emplace_back("SYNC_HEADING", heading);
+
+        auto animation = StateUpdate(SYNC_ANIMATION);
+        animation.stateUpdate.animation.sequence = 1042;
+        animation.stateUpdate.animation.entries = { { 408, 90110 }, { 411, 90420 }, { 407, 90515 }, { 412, 90730 } };
+        packets.emplace_back("SYNC_ANIMATION", animation);
+
+        auto weaponMode = StateUpdate(SYNC_WEAPON_MODE);
+        weaponMode.stateUpdate.weaponMode.weaponMode = 3;
+        packets.emplace_back("SYNC_WEAPON_MODE", weaponMode);
+
+        packets.emplace_back("DESTROY_NPC", StateUpdate(DESTROY_NPC));
+        packets.emplace_back("RELEASE_NPC", StateUpdate(RELEASE_NPC));
+
+        auto attacks = StateUpdate(SYNC_ATTACKS);
+        for (int i = 0; i < 3; i++) {
+            AttackInfo attack;
+            attack.target = "WOLF-NW_FOREST_PATH_35_01-7";
+            attack.damage = 42.0f;
+            attack.damageMode = 2;
+            attacks.stateUpdate.attacks.attacks.push_back(attack);
+        }
+        packets.emplace_back("SYNC_ATTACKS", attacks);
+
+        auto armor = StateUpdate(SYNC_ARMOR, "FRIEND_1");
+        armor.stateUpdate.armor.armor = "ITAR_MIL_L";
+        packets.emplace_back("SYNC_ARMOR", armor);
+
+        auto weapons = StateUpdate(SYNC_WEAPONS, "FRIEND_1");
+        weapons.stateUpdate.weapons.weapon1 = "ITMW_1H_MIL_SWORD";
+        weapons.stateUpdate.weapons.weapon2 = "ITRW_BOW_L_02";
+        packets.emplace_back("SYNC_WEAPONS", weapons);
+
+        auto hp = StateUpdate(SYNC_HP);
+        hp.stateUpdate.hp.hp = 80;
+        hp.stateUpdate.hp.hpMax = 120;
+        packets.emplace_back("SYNC_HP", hp);
+
+        auto time = StateUpdate(SYNC_TIME, "HOST");
+        time.stateUpdate.time.rawTime = 123456.0f;
+        packets.emplace_back("SYNC_TIME", time);
+
+        auto hand = StateUpdate(SYNC_HAND, "FRIEND_1");
+        hand.stateUpdate.hand.leftItem = "NULL";
+        hand.stateUpdate.hand.rightItem = "ITFO_APPLE";
+        packets.emplace_back("SYNC_HAND", hand);
+
+        auto magicSetup = StateUpdate(SYNC_MAGIC_SETUP, "FRIEND_1");
+        magicSetup.stateUpdate.magicSetup.spellInstanceName = "ITRU_FIREBOLT";
+        packets.emplace_back("SYNC_MAGIC_SETUP", magicSetup);
+
+        auto spellCast = StateUpdate(SYNC_SPELL_CAST, "FRIEND_1");
+        SpellCastInfo cast;
+        cast.target = "WOLF-NW_FOREST_PATH_35_01-7";
+        cast.spellInstanceId = 9001;
+        cast.spellLevel = 1;
+        spellCast.stateUpdate.spellCasts.casts.push_back(cast);
+        packets.emplace_back("SYNC_SPELL_CAST", spellCast);
+
+        auto revived = StateUpdate(SYNC_REVIVED, "FRIEND_1");
+        revived.stateUpdate.revived.name = "FRIEND_2";
+        packets.emplace_back("SYNC_REVIVED", revived);
+
+        auto protections = StateUpdate(SYNC_PROTECTIONS, "FRIEND_1");
+        for (int i = 0; i < 8; i++) {
+            protections.stateUpdate.protections.protections[i] = 10 * i;
+        }
+        packets.emplace_back("SYNC_PROTECTIONS", protections);
+
+        auto talents = StateUpdate(SYNC_TALENTS, "FRIEND_1");
+        for (int i = 0; i < 4; i++) {
+            talents.stateUpdate.talents.talents[i] = i;
+        }
+        packets.emplace_back("SYNC_TALENTS", talents);
+
+        auto bodyState = StateUpdate(SYNC_BODYSTATE);
+        bodyState.stateUpdate.bodyState.bodyState = 17;
+        packets.emplace_back("SYNC_BODYSTATE", bodyState);
+
+        auto overlays = StateUpdate(SYNC_OVERLAYS);
+        overlays.stateUpdate.overlays.overlays = { 7, 12 };
+        packets.emplace_back("SYNC_OVERLAYS", overlays);
+
+        auto dropItem = StateUpdate(SYNC_DROPITEM, "FRIEND_1");
+        dropItem.stateUpdate.dropItem.itemDropped = "ITMI_GOLD";
+        dropItem.stateUpdate.dropItem.itemUniqueName = "ITMI_GOLD-1700000000";
+        dropItem.stateUpdate.dropItem.count = 25;
+        packets.emplace_back("SYNC_DROPITEM", dropItem);
+
+        auto takeItem = StateUpdate(SYNC_TAKEITEM, "FRIEND_1");
+        takeItem.stateUpdate.takeItem.itemDropped = "ITMI_GOLD";
+        takeItem.stateUpdate.takeItem.uniqueName = "ITMI_GOLD-1700000000";
+        takeItem.stateUpdate.takeItem.count = 25;
+        packets.emplace_back("SYNC_TAKEITEM", takeItem);
+
+        NetworkPacket snapshot;
+        snapshot.type = PacketType::StateSnapshot;
+        snapshot.senderId = "HOST";
+        snapshot.snapshot.sequence = 10;
+        snapshot.snapshot.baselineSequence = 8;
+        for (int i = 0; i < 16; i++) {
+            EntitySnapshot entity;
+            entity.name = "WOLF-NW_FOREST_PATH_35_01-" + std::to_string(i);
+            entity.fieldMask = SNAPSHOT_POS | SNAPSHOT_HEADING;
+            snapshot.snapshot.entities.push_back(entity);
+        }
+        packets.emplace_back("StateSnapshot", snapshot);
+
+        NetworkPacket ack;
+        ack.type = PacketType::SnapshotAck;
+        ack.snapshotAck.sequence = 10;
+        packets.emplace_back("SnapshotAck", ack);
+
+        NetworkPacket authority;
+        authority.type = PacketType::NpcAuthority;
+        authority.senderId = "HOST";
+        for (int i = 0; i < 8; i++) {
+            NpcAuthorityEntry entry;
+            entry.npc = "WOLF-NW_FOREST_PATH_35_01-" + std::to_string(i);
+            entry.owner = "FRIEND_1";
+            authority.authority.entries.push_back(entry);
+        }
+        packets.emplace_back("NpcAuthority", authority);
+
+        return packets;
+    }
+
+    void PacketBenchmarks() {
+        for (const auto& sample : SamplePackets()) {
+            const auto& packet = sample.second;
+            std::vector<std::uint8_t> payload;
+            std::string error;
+            if (!SerializeNetworkPacket(packet, payload, error)) {
+                std::fprintf(stderr, "Cannot serialize %s: %s\n", sample.first.c_str(), error.c_str());
+                continue;
+            }
+
+            Run("serialize/" + sample.first, [&](std::uint64_t iterations) {
+                std::vector<std::uint8_t> out;
+                std::string serializeError;
+                for (std::uint64_t i = 0; i < iterations; i++) {
+                    SerializeNetworkPacket(packet, out, serializeError);
+                    DoNotOptimize(out);
+                }
+            }, 1.0, static_cast<double>(payload.size()));
+
+            Run("deserialize/" + sample.first, [&](std::uint64_t iterations) {
+                NetworkPacket decoded;
+                std::string decodeError;
+                for (std::uint64_t i = 0; i < iterations; i++) {
+                    DeserializeNetworkPacket(payload.data(), payload.size(), decoded, decodeError, PacketDecodeMode::Client);
+                    DoNotOptimize(decoded);
+                }
+            }, 1.0, static_cast<double>(payload.size()));
+        }
+    }
+
+    // 60% attacks, the rest movement and animation, as seen in busy fights.
+    void AttackHeavyTraceBenchmark() {
+        const char* names[] = {
+            "ORCWARRIOR_ROAM-OW_ORC_PATH_03-3",
+            "BDT_1013_BANDIT_L-NW_CASTLEMINE_TOWER_05-1",
+            "SNAPPER-FP_ROAM_MEDIUMFOREST_KAP2_21-2",
+            "WOLF-NW_FOREST_PATH_35_01-7",
+            "HOST",
+            "FRIEND_1",
+        };
+        std::mt19937 rng(1337);
+        std::vector<std::vector<std::uint8_t>> trace;
+        std::size_t totalBytes = 0;
+        for (int i = 0; i < 4096; i++) {
+            NetworkPacket packet;
+            if (rng() % 10 < 6) {
+                packet = StateUpdate(SYNC_ATTACKS, "");
+                int count = 1 + rng() % 4;
+                for (int a = 0; a < count; a++) {
+                    AttackInfo attack;
+                    attack.target = names[rng() % 6];
+                    attack.damage = static_cast<float>(rng() % 200);
+                    packet.stateUpdate.attacks.attacks.push_back(attack);
+                }
+            }
+            else if (rng() % 2) {
+                packet = StateUpdate(SYNC_POS, "");
+                packet.stateUpdate.pos = { static_cast<float>(rng() % 10000), 0.0f, static_cast<float>(rng() % 10000) };
+            }
+            else {
+                packet = StateUpdate(SYNC_ANIMATION, "");
+                packet.stateUpdate.animation.sequence = static_cast<std::uint16_t>(i);
+                packet.stateUpdate.animation.entries = { { static_cast<int>(rng() % 2000), static_cast<std::uint32_t>(i * 33) } };
+            }
+            packet.senderId.clear();
+
+            std::vector<std::uint8_t> payload;
+            std::string error;
+            if (SerializeNetworkPacket(packet, payload, error)) {
+                totalBytes += payload.size();
+                trace.push_back(std::move(payload));
+            }
+        }
+
+        Run("decode/attack_heavy_trace_server", [&](std::uint64_t iterations) {
+            NetworkPacket decoded;
+            std::string error;
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                const auto& payload = trace[i % trace.size()];
+                DeserializeNetworkPacket(payload.data(), payload.size(), decoded, error, PacketDecodeMode::Server);
+                DoNotOptimize(decoded);
+            }
+        }, 1.0, static_cast<double>(totalBytes) / trace.size());
+    }
+
+    void WriterBenchmarks() {
+        const int sizes[] = { 16, 256, 4096, 16384 };
+        for (int size : sizes) {
+            Run("packet_writer/grow_" + std::to_string(size), [size](std::uint64_t iterations) {
+                for (std::uint64_t i = 0; i < iterations; i++) {
+                    PacketWriter writer;
+                    int written = 0;
+                    while (written < size) {
+                        writer.writeU8(1);
+                        writer.writeU16(2);
+                        writer.writeI32(3);
+                        writer.writeFloat(4.0f);
+                        written += 11;
+                    }
+                    DoNotOptimize(writer.data());
+                }
+            }, 1.0, static_cast<double>(size));
+        }
+    }
+
+    void SanitizeBenchmarks() {
+        const std::string clean = "BDT_1013_BANDIT_L-NW_CASTLEMINE_TOWER_05-1";
+        std::string dirty = clean;
+        dirty[5] = '\x07';
+        dirty[20] = '\x7F';
+
+        Run("sanitize/clean_42", [&](std::uint64_t iterations) {
+            std::string text;
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                text = clean;
+                SanitizeServerText(text, kMaxUniqueNameLength);
+                DoNotOptimize(text);
+            }
+        }, 1.0, static_cast<double>(clean.size()));
+
+        Run("sanitize/dirty_42", [&](std::uint64_t iterations) {
+            std::string text;
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                text = dirty;
+                SanitizeServerText(text, kMaxUniqueNameLength);
+                DoNotOptimize(text);
+            }
+        }, 1.0, static_cast<double>(dirty.size()));
+    }
+
+    void SafeQueueBenchmarks() {
+        const std::uint64_t batch = 10000;
+        Run("safe_queue/two_threads_int", [batch](std::uint64_t iterations) {
+            SafeQueue<int> queue;
+            std::uint64_t total = iterations * batch;
+            std::thread producer([&]() {
+                for (std::uint64_t i = 0; i < total; i++) {
+                    queue.enqueue(static_cast<int>(i));
+                }
+            });
+            std::uint64_t sum = 0;
+            for (std::uint64_t i = 0; i < total; i++) {
+                sum += queue.dequeue();
+            }
+            producer.join();
+            DoNotOptimize(sum);
+        }, static_cast<double>(batch));
+
+        auto packet = SamplePackets()[3].second;
+        Run("safe_queue/two_threads_network_packet", [batch, &packet](std::uint64_t iterations) {
+            SafeQueue<NetworkPacket> queue;
+            std::uint64_t total = iterations * batch;
+            std::thread producer([&]() {
+                for (std::uint64_t i = 0; i < total; i++) {
+                    queue.enqueue(packet);
+                }
+            });
+            for (std::uint64_t i = 0; i < total; i++) {
+                auto item = queue.dequeue();
+                DoNotOptimize(item);
+            }
+            producer.join();
+        }, static_cast<double>(batch));
+    }
+
+    // A lag spike worth of updates for one NPC: mostly positions and headings
+    // with an occasional attack, applied in one drain.
+    void RemoteUpdateQueueBenchmarks() {
+        const int backlog = 256;
+        std::vector<PlayerStateUpdatePacket> updates;
+        for (int i = 0; i < backlog; i++) {
+            PlayerStateUpdatePacket update;
+            update.updateType = i % 16 == 15 ? SYNC_ATTACKS : (i % 2 ? SYNC_HEADING : SYNC_POS);
+            update.pos.x = static_cast<float>(i);
+            update.heading.heading = static_cast<float>(i);
+            updates.push_back(update);
+        }
+
+        Run("remote_queue/backlog_256", [&updates](std::uint64_t iterations) {
+            RemoteUpdateQueue queue;
+            std::size_t applied = 0;
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                for (const auto& update : updates) {
+                    queue.Push(update);
+                }
+                queue.Drain([&applied](const PlayerStateUpdatePacket& update) {
+                    applied += static_cast<std::size_t>(update.updateType);
+                    return true;
+                });
+            }
+            DoNotOptimize(applied);
+        }, static_cast<double>(backlog));
+    }
+
+    // NPCs spread over a world the size of Khorinis, and the NPCs within
+    // broadcast range of three players, through the grid and by a full scan.
+    void SpatialGridBenchmarks() {
+        const int npcCount = 1000;
+        const float worldSize = 80000.0f;
+        const float radius = 4500.0f;
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> coordinate(-worldSize / 2, worldSize / 2);
+        std::vector<std::array<float, 3>> positions;
+        SpatialGrid<int> grid(2500.0f);
+        for (int i = 0; i < npcCount; i++) {
+            positions.push_back({ coordinate(random), coordinate(random) / 20, coordinate(random) });
+            grid.Update(i, positions[i][0], positions[i][1], positions[i][2]);
+        }
+        const float players[3][3] = { { 0.0f, 0.0f, 0.0f }, { 3000.0f, 0.0f, 1000.0f }, { -20000.0f, 0.0f, 15000.0f } };
+
+        Run("spatial_grid/query_3_players", [&grid, &players, radius](std::uint64_t iterations) {
+            std::size_t found = 0;
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                grid.QueryAny(players, 3, radius, [&found](int) {
+                    found++;
+                });
+            }
+            DoNotOptimize(found);
+        });
+
+        Run("spatial_grid/scan_3_players", [&positions, &players, radius](std::uint64_t iterations) {
+            std::size_t found = 0;
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                for (const auto& position : positions) {
+                    for (const auto& player : players) {
+                        float dx = position[0] - player[0];
+                        float dy = position[1] - player[1];
+                        float dz = position[2] - player[2];
+                        if (std::sqrt(dx * dx + dy * dy + dz * dz) < radius) {
+                            found++;
+                            break;
+                        }
+                    }
+                }
+            }
+            DoNotOptimize(found);
+        });
+
+        const std::size_t refreshCount = 64;
+        Run("spatial_grid/refresh_64", [&grid, &positions, refreshCount](std::uint64_t iterations) {
+            float drift = 0.0f;
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                drift += 10.0f;
+                grid.Refresh(refreshCount, [&positions, drift](int item, float* out) {
+                    out[0] = positions[item][0] + drift;
+                    out[1] = positions[item][1];
+                    out[2] = positions[item][2];
+                    return true;
+                });
+            }
+            DoNotOptimize(drift);
+        }, static_cast<double>(refreshCount));
+    }
+
+    void ConfigBenchmarks() {
+        std::string path = GOTHICCOOP_SOURCE_DIR "/GothicCoopConfig.toml";
+        if (!std::ifstream(path).good()) {
+            std::fprintf(stderr, "Missing %s, skipping config benchmark.\n", path.c_str());
+            return;
+        }
+
+        Run("config/load_from_file", [&path](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                Config config;
+                config.LoadFromFile(path, false);
+                DoNotOptimize(config);
+            }
+        });
+    }
+
+    std::string EscapeJson(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                escaped.push_back('\\');
+            }
+            escaped.push_back(c);
+        }
+        return escaped;
+    }
+
+    void WriteJson(std::FILE* out) {
+        std::fprintf(out, "{\n  \"suite\": \"network\",\n  \"timestamp\": %lld,\n", static_cast<long long>(std::time(nullptr)));
+#if defined(__VERSION__)
+        std::fprintf(out, "  \"compiler\": \"%s\",\n", EscapeJson(__VERSION__).c_str());
+#endif
+        std::fprintf(out, "  \"min_time_s\": %.3f,\n  \"benchmarks\": [\n", Settings.minTime);
+        for (std::size_t i = 0; i < Results.size(); i++) {
+            const auto& result = Results[i];
+            std::fprintf(out, "    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.2f, \"ns_per_op_min\": %.2f, \"ops_per_s\": %.0f",
+                EscapeJson(result.name).c_str(), static_cast<unsigned long long>(result.iterations),
+                result.nsPerOp, result.nsPerOpMin, result.nsPerOp > 0.0 ? 1e9 / result.nsPerOp : 0.0);
+            if (result.bytesPerOp > 0.0) {
+                std::fprintf(out, ", \"bytes_per_op\": %.1f", result.bytesPerOp);
+            }
+            std::fprintf(out, "}%s\n", i + 1 < Results.size() ? "," : "");
+        }
+        std::fprintf(out, "  ]\n}\n");
+    }
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            Settings.filter = argv[++i];
+        }
+        else if (arg == "--min-time" && i + 1 < argc) {
+            Settings.minTime = std::max(0.01, std::atof(argv[++i]));
+        }
+        else if (arg == "--out" && i + 1 < argc) {
+            Settings.outPath = argv[++i];
+        }
+        else {
+            std::fprintf(stderr, "Usage: %s [--filter TEXT] [--min-time SECONDS] [--out FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    PacketBenchmarks();
+    AttackHeavyTraceBenchmark();
+    WriterBenchmarks();
+    SanitizeBenchmarks();
+    SafeQueueBenchmarks();
+    RemoteUpdateQueueBenchmarks();
+    SpatialGridBenchmarks();
+    ConfigBenchmarks();
+
+    std::FILE* out = stdout;
+    if (!Settings.outPath.empty()) {
+        out = std::fopen(Settings.outPath.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "Unable to write %s\n", Settings.outPath.c_str());
+            return 1;
+        }
+    }
+    WriteJson(out);
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    return 0;
+}
@@ -11,6 +11,12 @@ namespace GOTHIC_ENGINE {
             }
         } resetClientThread(&ClientThread);
 
+        struct CaptureExitClose {
+            ~CaptureExitClose() {
+                StopPacketCapture(CaptureRole::Client);
+            }
+        } closeCapture;
+
         CoopLog("[Client] Thread entry.");
         if (enet_initialize() != 0)
         {
@@ -21,7 +27,7 @@ namespace GOTHIC_ENGINE {
         atexit(enet_deinitialize);
 
         ENetHost* client;
-        client = enet_host_create(NULL, 1, 2, 0, 0);
+        client = enet_host_create(NULL, 1, kNetworkChannelCount, 0, 0);
         if (client == NULL)
         {
             CoopLog("[Client] ENet host create failed.");
@@ -30,13 +36,14 @@ namespace GOTHIC_ENGINE {
         }
 
         CoopLog("[Client] ENet host created.");
+        StartPacketCapture(CaptureRole::Client);
         ENetAddress address;
         ENetEvent event;
         ENetPeer* peer;
         auto serverIp = CoopConfig.ConnectionServer();
         enet_address_set_host(&address, serverIp.c_str());
         address.port = ConnectionPort;
-        peer = enet_host_connect(client, &address, 2, 0);
+        peer = enet_host_connect(client, &address, kNetworkChannelCount, 0);
         if (peer == NULL)
         {
             CoopLog("[Client] ENet connect failed to create peer.");
@@ -63,8 +70,12 @@ namespace GOTHIC_ENGINE {
             try {
                 ENetEvent event;
                 auto eventStatus = enet_host_service(client, &event, 1);
+                FlushPacketCapture();
 
                 if (eventStatus > 0) {
+                    if (event.type == ENET_EVENT_TYPE_RECEIVE) {
+                        CapturePacket(CaptureDirection::Inbound, event.channelID, 0, event.packet->data, event.packet->dataLength);
+                    }
                     ReadyToBeReceivedPackets.enqueue(event);
                 }
 
@@ -72,13 +83,14 @@ namespace GOTHIC_ENGINE {
                     auto outboundPacket = ReadyToSendPackets.dequeue();
                     std::vector<std::uint8_t> payload;
                     std::string error;
-                    if (!SerializeNetworkPacket(outboundPacket, payload, error)) {
+                    ENetPacket* packet = CreateEnetPacket(outboundPacket, payload, error);
+                    if (!packet) {
                         ChatLog(string::Combine("Failed to serialize packet: %s", string(error.c_str())));
                         continue;
                     }
 
-                    ENetPacket* packet = enet_packet_create(payload.data(), payload.size(), PacketFlag(outboundPacket));
                     enet_peer_send(peer, PacketChannel(outboundPacket), packet);
+                    CapturePacket(CaptureDirection::Outbound, PacketChannel(outboundPacket), 0, payload.data(), payload.size());
                 }
             }
             catch (std::exception& ex) {
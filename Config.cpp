@@ -11,6 +11,21 @@ namespace GOTHIC_ENGINE {
         const int kDefaultPlayersDamageMultiplier = 50;
         const int kDefaultNpcsDamageMultiplier = 100;
         const int kDefaultStartupGuardMs = 2000;
+        const bool kDefaultSnapshotReplication = false;
+        const int kDefaultSnapshotIntervalMs = 50;
+        const int kDefaultPositionErrorThreshold = 20;
+        const int kDefaultNetworkTickRate = 30;
+        const int kDefaultApplyBudgetUs = 3000;
+        const bool kDefaultDistributedAuthority = false;
+        const int kDefaultInterestRadius = 4500;
+        const int kDefaultLodNearDistance = 1500;
+        const int kDefaultLodFarDistance = 3000;
+        const int kDefaultLodNearIntervalMs = 0;
+        const int kDefaultLodMidIntervalMs = 100;
+        const int kDefaultLodFarIntervalMs = 300;
+        const int kDefaultPulseBudgetUs = 2000;
+        const bool kDefaultCapturePackets = false;
+        const bool kDefaultVerifyNpcRegistry = false;
         const char* kDefaultBodyModel = "HUM_BODY_NAKED0";
         const char* kDefaultHeadModel = "HUM_HEAD_PONY";
 
@@ -43,6 +58,22 @@ namespace GOTHIC_ENGINE {
         const int kDamageMultiplierMax = 500;
         const int kStartupGuardMin = 0;
         const int kStartupGuardMax = 10000;
+        const int kSnapshotIntervalMin = 10;
+        const int kSnapshotIntervalMax = 1000;
+        const int kPositionErrorThresholdMin = 1;
+        const int kPositionErrorThresholdMax = 500;
+        const int kNetworkTickRateMin = 10;
+        const int kNetworkTickRateMax = 120;
+        const int kApplyBudgetMin = 500;
+        const int kApplyBudgetMax = 20000;
+        const int kInterestRadiusMin = 1000;
+        const int kInterestRadiusMax = 20000;
+        const int kLodDistanceMin = 0;
+        const int kLodDistanceMax = 10000;
+        const int kLodIntervalMin = 0;
+        const int kLodIntervalMax = 2000;
+        const int kPulseBudgetMin = 100;
+        const int kPulseBudgetMax = 20000;
 
         const toml::node* FindNode(const toml::table& table, const char* section, const char* key) {
             if (section && section[0] != '\0') {
@@ -149,6 +180,37 @@ namespace GOTHIC_ENGINE {
             return static_cast<int>(*value);
         }
 
+        template <typename LogFn>
+        bool ReadBool(const toml::table& table,
+                      const char* section,
+                      const char* key,
+                      bool defaultValue,
+                      bool required,
+                      bool* needsPersist,
+                      LogFn&& logIssue) {
+            const toml::node* node = FindNode(table, section, key);
+            if (!node) {
+                if (required) {
+                    logIssue("Missing required key '" + DescribeKey(section, key) + "', using default.");
+                    if (needsPersist) {
+                        *needsPersist = true;
+                    }
+                }
+                return defaultValue;
+            }
+
+            auto value = node->value<bool>();
+            if (!value) {
+                logIssue("Invalid type for key '" + DescribeKey(section, key) + "', expected boolean.");
+                if (needsPersist) {
+                    *needsPersist = true;
+                }
+                return defaultValue;
+            }
+
+            return *value;
+        }
+
         template <typename LogFn, typename ValidatorFn>
         std::string ReadKeyString(const toml::table& table,
                                   const char* key,
@@ -204,6 +266,21 @@ namespace GOTHIC_ENGINE {
         defaults.playersDamageMultiplier = kDefaultPlayersDamageMultiplier;
         defaults.npcsDamageMultiplier = kDefaultNpcsDamageMultiplier;
         defaults.startupGuardMs = kDefaultStartupGuardMs;
+        defaults.snapshotReplication = kDefaultSnapshotReplication;
+        defaults.snapshotIntervalMs = kDefaultSnapshotIntervalMs;
+        defaults.positionErrorThreshold = kDefaultPositionErrorThreshold;
+        defaults.networkTickRate = kDefaultNetworkTickRate;
+        defaults.applyBudgetUs = kDefaultApplyBudgetUs;
+        defaults.distributedAuthority = kDefaultDistributedAuthority;
+        defaults.interestRadius = kDefaultInterestRadius;
+        defaults.lodNearDistance = kDefaultLodNearDistance;
+        defaults.lodFarDistance = kDefaultLodFarDistance;
+        defaults.lodNearIntervalMs = kDefaultLodNearIntervalMs;
+        defaults.lodMidIntervalMs = kDefaultLodMidIntervalMs;
+        defaults.lodFarIntervalMs = kDefaultLodFarIntervalMs;
+        defaults.pulseBudgetUs = kDefaultPulseBudgetUs;
+        defaults.capturePackets = kDefaultCapturePackets;
+        defaults.verifyNpcRegistry = kDefaultVerifyNpcRegistry;
         defaults.toggleGameLogKey = kDefaultToggleGameLogKey;
         defaults.toggleGameStatsKey = kDefaultToggleGameStatsKey;
         defaults.startServerKey = kDefaultStartServerKey;
@@ -257,6 +334,25 @@ namespace GOTHIC_ENGINE {
         values_.playersDamageMultiplier = ReadInt(config, "gameplay", "playersDamageMultiplier", values_.playersDamageMultiplier, kDamageMultiplierMin, kDamageMultiplierMax, false, &needsPersist, logIssue);
         values_.npcsDamageMultiplier = ReadInt(config, "gameplay", "npcsDamageMultiplier", values_.npcsDamageMultiplier, kDamageMultiplierMin, kDamageMultiplierMax, false, &needsPersist, logIssue);
         values_.startupGuardMs = ReadInt(config, "gameplay", "startupGuardMs", values_.startupGuardMs, kStartupGuardMin, kStartupGuardMax, false, &needsPersist, logIssue);
+        values_.snapshotReplication = ReadBool(config, "network", "snapshotReplication", values_.snapshotReplication, false, &needsPersist, logIssue);
+        values_.snapshotIntervalMs = ReadInt(config, "network", "snapshotIntervalMs", values_.snapshotIntervalMs, kSnapshotIntervalMin, kSnapshotIntervalMax, false, &needsPersist, logIssue);
+        values_.positionErrorThreshold = ReadInt(config, "network", "positionErrorThreshold", values_.positionErrorThreshold, kPositionErrorThresholdMin, kPositionErrorThresholdMax, false, &needsPersist, logIssue);
+        values_.networkTickRate = ReadInt(config, "network", "tickRate", values_.networkTickRate, kNetworkTickRateMin, kNetworkTickRateMax, false, &needsPersist, logIssue);
+        values_.applyBudgetUs = ReadInt(config, "network", "applyBudgetUs", values_.applyBudgetUs, kApplyBudgetMin, kApplyBudgetMax, false, &needsPersist, logIssue);
+        values_.distributedAuthority = ReadBool(config, "network", "distributedAuthority", values_.distributedAuthority, false, &needsPersist, logIssue);
+        values_.interestRadius = ReadInt(config, "network", "interestRadius", values_.interestRadius, kInterestRadiusMin, kInterestRadiusMax, false, &needsPersist, logIssue);
+        values_.lodNearDistance = ReadInt(config, "lod", "nearDistance", values_.lodNearDistance, kLodDistanceMin, kLodDistanceMax, false, &needsPersist, logIssue);
+        values_.lodFarDistance = ReadInt(config, "lod", "farDistance", values_.lodFarDistance, kLodDistanceMin, kLodDistanceMax, false, &needsPersist, logIssue);
+        if (values_.lodFarDistance < values_.lodNearDistance) {
+            LogIssue("lod.farDistance is below lod.nearDistance, using nearDistance for both.");
+            values_.lodFarDistance = values_.lodNearDistance;
+        }
+        values_.lodNearIntervalMs = ReadInt(config, "lod", "nearIntervalMs", values_.lodNearIntervalMs, kLodIntervalMin, kLodIntervalMax, false, &needsPersist, logIssue);
+        values_.lodMidIntervalMs = ReadInt(config, "lod", "midIntervalMs", values_.lodMidIntervalMs, kLodIntervalMin, kLodIntervalMax, false, &needsPersist, logIssue);
+        values_.lodFarIntervalMs = ReadInt(config, "lod", "farIntervalMs", values_.lodFarIntervalMs, kLodIntervalMin, kLodIntervalMax, false, &needsPersist, logIssue);
+        values_.pulseBudgetUs = ReadInt(config, "lod", "pulseBudgetUs", values_.pulseBudgetUs, kPulseBudgetMin, kPulseBudgetMax, false, &needsPersist, logIssue);
+        values_.capturePackets = ReadBool(config, "debug", "capturePackets", values_.capturePackets, false, &needsPersist, logIssue);
+        values_.verifyNpcRegistry = ReadBool(config, "debug", "verifyNpcRegistry", values_.verifyNpcRegistry, false, &needsPersist, logIssue);
 
         auto isValidKey = [this](const std::string& keyValue) { return IsValidKeyCode(keyValue); };
         values_.toggleGameLogKey = ReadKeyString(config, "toggleGameLogKey", values_.toggleGameLogKey, &needsPersist, logIssue, isValidKey);
@@ -321,6 +417,66 @@ namespace GOTHIC_ENGINE {
         return values_.startupGuardMs;
     }
 
+    bool Config::SnapshotReplication() const {
+        return values_.snapshotReplication;
+    }
+
+    int Config::SnapshotIntervalMs() const {
+        return values_.snapshotIntervalMs;
+    }
+
+    int Config::PositionErrorThreshold() const {
+        return values_.positionErrorThreshold;
+    }
+
+    int Config::NetworkTickRate() const {
+        return values_.networkTickRate;
+    }
+
+    int Config::ApplyBudgetUs() const {
+        return values_.applyBudgetUs;
+    }
+
+    bool Config::DistributedAuthority() const {
+        return values_.distributedAuthority;
+    }
+
+    int Config::InterestRadius() const {
+        return values_.interestRadius;
+    }
+
+    int Config::LodNearDistance() const {
+        return values_.lodNearDistance;
+    }
+
+    int Config::LodFarDistance() const {
+        return values_.lodFarDistance;
+    }
+
+    int Config::LodNearIntervalMs() const {
+        return values_.lodNearIntervalMs;
+    }
+
+    int Config::LodMidIntervalMs() const {
+        return values_.lodMidIntervalMs;
+    }
+
+    int Config::LodFarIntervalMs() const {
+        return values_.lodFarIntervalMs;
+    }
+
+    int Config::PulseBudgetUs() const {
+        return values_.pulseBudgetUs;
+    }
+
+    bool Config::CapturePackets() const {
+        return values_.capturePackets;
+    }
+
+    bool Config::VerifyNpcRegistry() const {
+        return values_.verifyNpcRegistry;
+    }
+
     int Config::ToggleGameLogKeyCode() const {
         return ToKeyCode(values_.toggleGameLogKey, kDefaultToggleGameLogKey);
     }
@@ -367,6 +523,27 @@ namespace GOTHIC_ENGINE {
             {"npcsDamageMultiplier", values_.npcsDamageMultiplier},
             {"startupGuardMs", values_.startupGuardMs}
         });
+        config.insert("network", toml::table{
+            {"snapshotReplication", values_.snapshotReplication},
+            {"snapshotIntervalMs", values_.snapshotIntervalMs},
+            {"positionErrorThreshold", values_.positionErrorThreshold},
+            {"tickRate", values_.networkTickRate},
+            {"applyBudgetUs", values_.applyBudgetUs},
+            {"distributedAuthority", values_.distributedAuthority},
+            {"interestRadius", values_.interestRadius}
+        });
+        config.insert("lod", toml::table{
+            {"nearDistance", values_.lodNearDistance},
+            {"farDistance", values_.lodFarDistance},
+            {"nearIntervalMs", values_.lodNearIntervalMs},
+            {"midIntervalMs", values_.lodMidIntervalMs},
+            {"farIntervalMs", values_.lodFarIntervalMs},
+            {"pulseBudgetUs", values_.pulseBudgetUs}
+        });
+        config.insert("debug", toml::table{
+            {"capturePackets", values_.capturePackets},
+            {"verifyNpcRegistry", values_.verifyNpcRegistry}
+        });
         config.insert("controls", toml::table{
             {"toggleGameLogKey", values_.toggleGameLogKey},
             {"toggleGameStatsKey", values_.toggleGameStatsKey},
@@ -51,6 +51,21 @@ namespace GOTHIC_ENGINE {
             int playersDamageMultiplier = 0;
             int npcsDamageMultiplier = 0;
             int startupGuardMs = 0;
+            bool snapshotReplication = false;
+            int snapshotIntervalMs = 0;
+            int positionErrorThreshold = 0;
+            int networkTickRate = 0;
+            int applyBudgetUs = 0;
+            bool distributedAuthority = false;
+            int interestRadius = 0;
+            int lodNearDistance = 0;
+            int lodFarDistance = 0;
+            int lodNearIntervalMs = 0;
+            int lodMidIntervalMs = 0;
+            int lodFarIntervalMs = 0;
+            int pulseBudgetUs = 0;
+            bool capturePackets = false;
+            bool verifyNpcRegistry = false;
             std::string toggleGameLogKey;
             std::string toggleGameStatsKey;
             std::string startServerKey;
@@ -75,6 +90,21 @@ namespace GOTHIC_ENGINE {
         int PlayersDamageMultiplier() const;
         int NpcsDamageMultiplier() const;
         int StartupGuardMs() const;
+        bool SnapshotReplication() const;
+        int SnapshotIntervalMs() const;
+        int PositionErrorThreshold() const;
+        int NetworkTickRate() const;
+        int ApplyBudgetUs() const;
+        bool DistributedAuthority() const;
+        int InterestRadius() const;
+        int LodNearDistance() const;
+        int LodFarDistance() const;
+        int LodNearIntervalMs() const;
+        int LodMidIntervalMs() const;
+        int LodFarIntervalMs() const;
+        int PulseBudgetUs() const;
+        bool CapturePackets() const;
+        bool VerifyNpcRegistry() const;
 
         int ToggleGameLogKeyCode() const;
         int ToggleGameStatsKeyCode() const;
@@ -1,20 +1,10 @@
 namespace GOTHIC_ENGINE {
-    void DamageProcessorLoop() {
-        PluginState = "DamageProcessorLoop";
-
-        if (ReadyToSyncDamages.isEmpty()) {
-            return;
-        }
-
-        auto hit = ReadyToSyncDamages.dequeue();
-
-        if (!ClientThread && !ServerThread)
-        {
-            return;
-        }
+    static std::vector<PlayerHit> PendingDamages;
+    static std::vector<oCNpc*> PendingDamageNpcs;
 
+    void ProcessDamage(PlayerHit& hit) {
         if (Myself && hit.attacker == Myself->npc) {
-            if (!EnsureNpcUniqueName(hit.npc)) {
+            if (!NpcToUniqueNameList.count(hit.npc)) {
                 return;
             }
 
@@ -28,30 +18,59 @@ namespace GOTHIC_ENGINE {
             return;
         }
 
-        if (ServerThread) {
-            if (PlayerNpcs.count(hit.attacker)) {
-                return;
-            }
+        // Hits by NPCs this peer broadcasts. BroadcastNpcs only holds NPCs
+        // this peer owns, so every hit is sent by exactly one peer.
+        if (PlayerNpcs.count(hit.attacker)) {
+            return;
+        }
 
-            if (!EnsureNpcUniqueName(hit.attacker)) {
-                return;
-            }
+        if (!NpcToUniqueNameList.count(hit.attacker)) {
+            return;
+        }
 
-            auto uniqueNpcName = NpcToUniqueNameList[hit.attacker];
-            if (uniqueNpcName && BroadcastNpcs.count(uniqueNpcName)) {
-                if (hit.npc == player) {
-                    hit.npcUniqueName = "HOST";
-                    BroadcastNpcs[uniqueNpcName]->hitsToSync.push_back(hit);
-                }
-                else if (PlayerNpcs.count(hit.npc)) {
-                    hit.npcUniqueName = PlayerNpcs[hit.npc];
-                    BroadcastNpcs[uniqueNpcName]->hitsToSync.push_back(hit);
-                }
-                else if (EnsureNpcUniqueName(hit.npc)) {
-                    hit.npcUniqueName = NpcToUniqueNameList[hit.npc];
-                    BroadcastNpcs[uniqueNpcName]->hitsToSync.push_back(hit);
-                }
+        auto uniqueNpcName = NpcToUniqueNameList[hit.attacker];
+        if (uniqueNpcName && BroadcastNpcs.count(uniqueNpcName)) {
+            if (hit.npc == player) {
+                hit.npcUniqueName = MyselfId;
+                BroadcastNpcs[uniqueNpcName]->hitsToSync.push_back(hit);
             }
+            else if (PlayerNpcs.count(hit.npc)) {
+                hit.npcUniqueName = PlayerNpcs[hit.npc];
+                BroadcastNpcs[uniqueNpcName]->hitsToSync.push_back(hit);
+            }
+            else if (NpcToUniqueNameList.count(hit.npc)) {
+                hit.npcUniqueName = NpcToUniqueNameList[hit.npc];
+                BroadcastNpcs[uniqueNpcName]->hitsToSync.push_back(hit);
+            }
+        }
+    }
+
+    // Handles every hit queued since the last frame. Hits land in the
+    // attacker's hitsToSync and go out as one SYNC_ATTACKS on its next tick.
+    void DamageProcessorLoop() {
+        PluginState = "DamageProcessorLoop";
+
+        if (ReadyToSyncDamages.isEmpty()) {
+            return;
+        }
+
+        PendingDamages.clear();
+        ReadyToSyncDamages.dequeueAll(PendingDamages);
+
+        if (!ClientThread && !ServerThread)
+        {
+            return;
+        }
+
+        PendingDamageNpcs.clear();
+        for (auto& hit : PendingDamages) {
+            PendingDamageNpcs.push_back(hit.npc);
+            PendingDamageNpcs.push_back(hit.attacker);
+        }
+        EnsureNpcUniqueNames(PendingDamageNpcs);
+
+        for (auto& hit : PendingDamages) {
+            ProcessDamage(hit);
         }
     }
 }
\ No newline at end of file
@@ -25,6 +25,11 @@ namespace GOTHIC_ENGINE {
             if (ServerThread) {
                 ChatLog("broadcastNpcs:");
                 ChatLog(BroadcastNpcs.size());
+                ChatLog(string::Combine("pulsed last frame: %i, max staleness: %i ms", BroadcastPulsesLastFrame, static_cast<int>(BroadcastMaxStalenessMs)));
+                for (auto friendIdNumber : ActiveFriendIds) {
+                    auto interested = InterestedNpcsPerPeer.find(friendIdNumber);
+                    ChatLog(string::Combine("FRIEND_%i interested in: %i", friendIdNumber, interested != InterestedNpcsPerPeer.end() ? interested->second : 0));
+                }
 
                 for each (auto i in BroadcastNpcs) {
                     ChatLog(i.first);
@@ -33,6 +38,18 @@ namespace GOTHIC_ENGINE {
             if (ClientThread) {
                 ChatLog("SyncNpcs:");
                 ChatLog(SyncNpcs.size());
+                ChatLog(string::Combine("deferred updates last frame: %i", RemoteApplyDeferredLastFrame));
+                int staleNpcs = 0;
+                long long maxStalenessMs = 0;
+                for each (auto i in SyncNpcs) {
+                    if (i.second->IsTransformStale()) {
+                        staleNpcs++;
+                    }
+                    if (i.second->TransformStalenessMs() > maxStalenessMs) {
+                        maxStalenessMs = i.second->TransformStalenessMs();
+                    }
+                }
+                ChatLog(string::Combine("stale transforms: %i, max staleness: %i ms", staleNpcs, static_cast<int>(maxStalenessMs)));
 
                 for each (auto i in SyncNpcs) {
                     ChatLog(i.first);
@@ -4,6 +4,39 @@ namespace GOTHIC_ENGINE {
     const int COOP_VERSION = 60;
     const int COOP_MAGIC_NUMBER = 1337;
     int BROADCAST_DISTANCE = 4500;
+    // Friends are removed from the world only this far past BROADCAST_DISTANCE,
+    // so a player walking along the edge is not despawned and respawned.
+    const int COOP_FRIEND_DESPAWN_MARGIN = 500;
+    // A player takes over an NPC only when this much closer than its current
+    // owner, and asks again no sooner than NPC_AUTHORITY_CLAIM_RETRY_MS.
+    const float NPC_AUTHORITY_HANDOFF_MARGIN = 500.0f;
+    const int NPC_AUTHORITY_CLAIM_RETRY_MS = 1000;
+    // A peer stops receiving an NPC only this far past InterestRadius, so an
+    // NPC at the edge is not released and respawned over and over.
+    const float INTEREST_HYSTERESIS = 500.0f;
+    const int INTEREST_UPDATE_MS = 250;
+    // The interest pass looks up NPCs near the peers in the NPC grid, whose
+    // positions lag a few frames behind; the query radius is widened by this.
+    const float INTEREST_GRID_SLACK = 1000.0f;
+    // Cells of the NPC grid are about half the broadcast distance wide, and
+    // this many NPC positions are re-read per frame.
+    const float NPC_GRID_CELL_SIZE = 2500.0f;
+    const std::size_t NPC_GRID_REFRESH_PER_FRAME = 64;
+    const int DEAD_RECKONING_REFRESH_MS = 1000;
+    const int DEAD_RECKONING_SETTLE_MS = 250;
+    const float DEAD_RECKONING_MIN_SPEED = 20.0f;
+    // Position and heading are unreliable, so the full transform is resent this
+    // often even when nothing changed. Receivers that heard nothing for
+    // TRANSFORM_STALE_MS treat the entity as stale.
+    const int TRANSFORM_KEYFRAME_MS = 2000;
+    const int TRANSFORM_STALE_MS = 5000;
+    const float REMOTE_POSITION_TOLERANCE = 1.0f;
+    const float REMOTE_HEADING_TOLERANCE = 0.5f;
+    const size_t REMOTE_ITEM_CACHE_SIZE = 8;
+    const size_t REMOTE_SPELL_CACHE_SIZE = 8;
+    const int ANIMATION_STREAM_REDUNDANCY = 4;
+    const int ANIMATION_STREAM_RESENDS = 2;
+    const int ANIMATION_STREAM_STALE_MS = 300;
 
     DWORD MainThreadId;
     std::string PluginState = "";
@@ -53,6 +86,31 @@ namespace GOTHIC_ENGINE {
 
     int ConnectionPort = 1234;
 
+    bool SnapshotReplication = false;
+    int SnapshotIntervalMs = 50;
+    int PositionErrorThreshold = 20;
+    int NetworkTickRate = 30;
+    static double NetworkTickAccumulatorMs = 0;
+    static long long LastNetworkTickFrameMs = 0;
+    int ApplyBudgetUs = 3000;
+    ApplyBudget RemoteApplyBudget;
+    SpatialGrid<oCNpc*> NpcGrid(NPC_GRID_CELL_SIZE);
+    int RemoteApplyDeferredLastFrame = 0;
+    bool DistributedAuthority = false;
+    int InterestRadius = 4500;
+    std::map<int, int> InterestedNpcsPerPeer;
+    int LodNearDistance = 1500;
+    int LodFarDistance = 3000;
+    int LodNearIntervalMs = 0;
+    int LodMidIntervalMs = 100;
+    int LodFarIntervalMs = 300;
+    int PulseBudgetUs = 2000;
+    int BroadcastPulsesLastFrame = 0;
+    long long BroadcastMaxStalenessMs = 0;
+    bool CapturePackets = false;
+    bool VerifyNpcRegistry = false;
+    static PacketCaptureWriter PacketCapture;
+
     static Thread ServerThreadStorage;
     static Thread ClientThreadStorage;
     static Thread* ServerThread = NULL;
@@ -66,6 +124,10 @@ namespace GOTHIC_ENGINE {
 
     static std::map<string, int> NamesCounter;
     static std::map<oCNpc*, string> NpcToFirstRoutineWp;
+    // Names are given by one full pass when a level is loaded and afterwards
+    // to each NPC the world inserts, queued by the insert hook.
+    static bool NpcRegistryInitialized = false;
+    static std::vector<oCNpc*> PendingNpcRegistrations;
 
     static std::map<oCNpc*, string> PlayerNpcs;
     static std::map<string, oCNpc*> PlayerNameToNpc;
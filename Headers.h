@@ -4,6 +4,9 @@
 // Automatically generated block
 #pragma region Includes
 #include "Config.h"
+#include "NetworkPackets.h"
+#include "StateSnapshots.h"
+#include "NetTransport.h"
 #include "MappedPort.h"
 #include "KeyCodes.h"
 #include "Plugin.h"
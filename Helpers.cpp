@@ -1,4 +1,5 @@
 #include <fstream>
+#include <sstream>
 
 namespace GOTHIC_ENGINE {
     void CoopLog(std::string l)
@@ -50,27 +51,38 @@ namespace GOTHIC_ENGINE {
         return zfactory->CreateItem(insIndex);
     }
 
+    void AddNpcToGrid(oCNpc* npc) {
+        auto position = npc->GetPositionWorld();
+        NpcGrid.Update(npc, position.n[0], position.n[1], position.n[2]);
+    }
+
+    // Re-reads a slice of the NPC positions each frame, so every NPC in the
+    // world is refreshed every few frames without touching all of them at once.
+    void RefreshNpcGrid() {
+        NpcGrid.Refresh(NPC_GRID_REFRESH_PER_FRAME, [](oCNpc* npc, float* out) {
+            auto position = npc->GetPositionWorld();
+            out[0] = position.n[0];
+            out[1] = position.n[1];
+            out[2] = position.n[2];
+            return true;
+        });
+    }
+
     std::vector<oCNpc*> GetVisibleNpcs() {
         std::vector<oCNpc*> npcs;
-        auto* list = ogame->GetGameWorld()->voblist_npcs->next;
-
-        while (list) {
-            auto npc = list->data;
-            auto npcPosition = npc->GetPositionWorld();
-            auto playerPosition = player->GetPositionWorld();
+        if (!player) {
+            return npcs;
+        }
 
+        auto playerPosition = player->GetPositionWorld();
+        NpcGrid.Query(playerPosition.n[0], playerPosition.n[1], playerPosition.n[2], static_cast<float>(BROADCAST_DISTANCE), [&npcs](oCNpc* npc) {
             if (npc->vobLeafList.GetNum() == 0) {
-                list = list->next;
-                continue;
+                return;
             }
-
-            if (playerPosition.Distance(npcPosition) < BROADCAST_DISTANCE) {
-                if (!npc->IsAPlayer() && !npc->GetObjectName().StartWith("FRIEND_")) {
-                    npcs.push_back(npc);
-                }
+            if (!npc->IsAPlayer() && !npc->GetObjectName().StartWith("FRIEND_")) {
+                npcs.push_back(npc);
             }
-            list = list->next;
-        }
+        });
 
         return npcs;
     }
@@ -143,11 +155,49 @@ namespace GOTHIC_ENGINE {
         return false;
     }
 
-    void BuildGlobalNpcList() {
+    static bool IsNameableNpc(oCNpc* npc) {
+        return !npc->IsAPlayer() && !npc->GetObjectName().StartWith("FRIEND_") && !IgnoredSyncNpc(npc);
+    }
+
+    // NPCs from the level are named after their first routine waypoint;
+    // NPCs inserted later are marked DYNAMIC.
+    static bool NameNpc(oCNpc* npc, bool fromLevel) {
+        if (NpcToUniqueNameList.count(npc) || !IsNameableNpc(npc)) {
+            return false;
+        }
+
+        auto objectName = string(npc->GetObjectName());
+        CStringA name = "";
+        if (NamesCounter[objectName] == 1) {
+            name = objectName;
+        }
+        else {
+            auto secondUniquePart = npc->wpname ? string(npc->wpname) : string("UNKNOW");
+            auto routineWp = NpcToFirstRoutineWp.find(npc);
+            if (routineWp != NpcToFirstRoutineWp.end() && !routineWp->second.IsEmpty()) {
+                secondUniquePart = routineWp->second;
+            }
+            if (!fromLevel) {
+                secondUniquePart = npc->wpname ? string::Combine("DYNAMIC-%s", string(npc->wpname)) : string("DYNAMIC");
+            }
+            name = string::Combine("%s-%s", objectName, secondUniquePart);
+            NamesCounter[name] += 1;
+        }
+
+        auto uniqueName = string::Combine("%s-%i", name, NamesCounter[name]);
+        UniqueNameToNpcList[uniqueName] = npc;
+        NpcToUniqueNameList[npc] = uniqueName;
+        return true;
+    }
+
+    // Full pass over the world. Runs once per level to name the NPCs loaded
+    // with it; later passes are only a consistency check and return how many
+    // NPCs the insert hook missed.
+    int BuildGlobalNpcList() {
         PluginState = "BuildGlobalNpcList";
 
         auto* list = ogame->GetGameWorld()->voblist_npcs->next;
-        auto firstRun = NpcToFirstRoutineWp.size() == 0;
+        auto firstRun = !NpcRegistryInitialized;
 
         if (firstRun) {
             auto* rtnList = rtnMan->rtnList.next;
@@ -166,55 +216,64 @@ namespace GOTHIC_ENGINE {
             }
         }
 
+        int missed = 0;
         list = ogame->GetGameWorld()->voblist_npcs->next;
         while (list) {
             auto npc = list->data;
-
-            if (npc->IsAPlayer() || npc->GetObjectName().StartWith("FRIEND_") || IgnoredSyncNpc(npc) || NpcToUniqueNameList.count(npc)) {
-                list = list->next;
-                continue;
+            bool added = false;
+            if (!NpcGrid.Contains(npc)) {
+                AddNpcToGrid(npc);
+                added = true;
             }
-
-            auto objectName = string(npc->GetObjectName());
-            CStringA name = "";
-            if (NamesCounter[objectName] == 1) {
-                name = objectName;
-            }
-            else {
-                auto secondUniquePart = npc->wpname ? string(npc->wpname) : string("UNKNOW");
-                if (NpcToFirstRoutineWp.count(npc) > 0 && !NpcToFirstRoutineWp[npc].IsEmpty()) {
-                    secondUniquePart = NpcToFirstRoutineWp[npc];
-                }
-                if (!firstRun) {
-                    secondUniquePart = npc->wpname ? string::Combine("DYNAMIC-%s", string(npc->wpname)) : string("DYNAMIC");
-                }
-                name = string::Combine("%s-%s", string(npc->GetObjectName()), secondUniquePart);
-                NamesCounter[name] += 1;
+            if (NameNpc(npc, firstRun) || added) {
+                missed++;
             }
+            list = list->next;
+        }
 
-            auto uniqueName = string::Combine("%s-%i", name, NamesCounter[name]);
-            UniqueNameToNpcList[uniqueName] = npc;
-            NpcToUniqueNameList[npc] = uniqueName;
+        NpcRegistryInitialized = true;
+        PendingNpcRegistrations.clear();
+        return firstRun ? 0 : missed;
+    }
 
-            list = list->next;
+    void QueueNpcRegistration(oCNpc* npc) {
+        PendingNpcRegistrations.push_back(npc);
+    }
+
+    void UnqueueNpcRegistration(oCNpc* npc) {
+        auto it = std::find(PendingNpcRegistrations.begin(), PendingNpcRegistrations.end(), npc);
+        if (it != PendingNpcRegistrations.end()) {
+            PendingNpcRegistrations.erase(it);
         }
     }
 
-    bool EnsureNpcUniqueName(oCNpc* npc) {
-        if (!npc) {
-            return false;
+    // Names and indexes the NPCs inserted since the last call, in insertion order.
+    void RegisterPendingNpcs() {
+        if (!NpcRegistryInitialized || PendingNpcRegistrations.empty()) {
+            return;
         }
 
-        if (NpcToUniqueNameList.count(npc) > 0) {
-            return true;
+        for (auto npc : PendingNpcRegistrations) {
+            AddNpcToGrid(npc);
+            NameNpc(npc, false);
         }
+        PendingNpcRegistrations.clear();
+    }
 
-        if (npc->IsAPlayer() || npc->GetObjectName().StartWith("FRIEND_") || IgnoredSyncNpc(npc)) {
-            return false;
+    // Makes sure every nameable NPC in npcs has a unique name. NPCs the insert
+    // hook did not see are named on the spot.
+    void EnsureNpcUniqueNames(const std::vector<oCNpc*>& npcs) {
+        if (!NpcRegistryInitialized) {
+            BuildGlobalNpcList();
+            return;
         }
 
-        BuildGlobalNpcList();
-        return NpcToUniqueNameList.count(npc) > 0;
+        RegisterPendingNpcs();
+        for (auto npc : npcs) {
+            if (npc && !NpcToUniqueNameList.count(npc) && NameNpc(npc, false) && !NpcGrid.Contains(npc)) {
+                AddNpcToGrid(npc);
+            }
+        }
     }
 
     long long GetCurrentMs() {
@@ -243,4 +302,37 @@ namespace GOTHIC_ENGINE {
 
         return instId;
     }
+
+    void StartPacketCapture(CaptureRole role) {
+        if (!CapturePackets) {
+            return;
+        }
+
+        std::ostringstream path;
+        path << GothicExeFolderPath << "\\GothicCoopCapture-" << GetCurrentMs() << ".gcap";
+        if (PacketCapture.Open(path.str(), role)) {
+            CoopLog("[Capture] Writing packets to " + path.str() + "\r\n");
+        }
+        else {
+            CoopLog("[Capture] Unable to open " + path.str() + "\r\n");
+        }
+    }
+
+    void StopPacketCapture(CaptureRole role) {
+        if (PacketCapture.Close(role)) {
+            CoopLog("[Capture] Capture closed.\r\n");
+        }
+    }
+
+    void CapturePacket(CaptureDirection direction, int channel, int peer, const void* data, std::size_t length) {
+        if (CapturePackets) {
+            PacketCapture.Write(direction, static_cast<std::uint8_t>(channel), static_cast<std::uint16_t>(peer), static_cast<const std::uint8_t*>(data), length);
+        }
+    }
+
+    void FlushPacketCapture() {
+        if (CapturePackets) {
+            PacketCapture.FlushIfDue();
+        }
+    }
 }
\ No newline at end of file
@@ -7,15 +7,25 @@ namespace GOTHIC_ENGINE {
             return true;
         }
 
-        // Blocking animations on clients for NPC is not preventing attacking sometimes (so do not call unless attack from the coop engine)
-        if (ClientThread &&
-            damdesc.pNpcAttacker != player &&
+        // Blocking animations on clients for NPC is not preventing attacking sometimes (so do not call unless attack from the coop engine).
+        // The same goes for NPCs simulated by another peer: their hits on players arrive from that peer.
+        bool attackerSimulatedElsewhere = damdesc.pNpcAttacker != player &&
+            !IsNpcSimulatedLocally(damdesc.pNpcAttacker) &&
+            (ClientThread || (ServerThread && damdesc.pNpcAttacker && !PlayerNpcs.count(damdesc.pNpcAttacker)));
+        if (attackerSimulatedElsewhere &&
             (_this == player || IsCoopPlayer(_this->GetObjectName())) &&
             damdesc.fDamageTotal != COOP_MAGIC_NUMBER &&
             damdesc.enuModeDamage != oETypeDamage::oEDamageType_Fall) {
             return true;
         }
 
+        // Hits of puppet NPCs on other NPCs arrive from the owner as SYNC_ATTACKS.
+        if (IsNpcPuppet(damdesc.pNpcAttacker) &&
+            damdesc.fDamageTotal != COOP_MAGIC_NUMBER &&
+            damdesc.enuModeDamage != oETypeDamage::oEDamageType_Fall) {
+            return true;
+        }
+
         return false;
     }
 
@@ -36,7 +46,7 @@ namespace GOTHIC_ENGINE {
         }
 
 #if ENGINE == Engine_G1
-        if (ServerThread && damdesc.pNpcAttacker && (damdesc.pNpcAttacker == player || PlayerNpcs.count(damdesc.pNpcAttacker))) {
+        if (IsNpcSimulatedLocally(_this) && damdesc.pNpcAttacker && (damdesc.pNpcAttacker == player || PlayerNpcs.count(damdesc.pNpcAttacker))) {
             if (_this->GetAttitude(damdesc.pNpcAttacker) == NPC_ATT_HOSTILE) {
                 auto randValue = GetRandVal(0, 100);
                 if (randValue > 33) {
@@ -46,7 +56,7 @@ namespace GOTHIC_ENGINE {
         }
 #endif
 
-        if (ClientThread && damdesc.pNpcAttacker != player) {
+        if ((ClientThread && damdesc.pNpcAttacker != player && !IsNpcSimulatedLocally(damdesc.pNpcAttacker)) || IsNpcPuppet(damdesc.pNpcAttacker)) {
             Ivk_oCNpc_OnDamage_Hit(_this, damdesc);
             return;
         }
@@ -118,12 +128,12 @@ namespace GOTHIC_ENGINE {
             return;
         }
 
-        if (ClientThread && damdesc.pNpcAttacker != player) {
+        if ((ClientThread && damdesc.pNpcAttacker != player && !IsNpcSimulatedLocally(damdesc.pNpcAttacker)) || IsNpcPuppet(damdesc.pNpcAttacker)) {
             Ivk_oCNpc_OnDamage_Sound(_this, damdesc);
             return;
         }
 
-        if (ServerThread && PlayerNpcs.count(damdesc.pNpcAttacker)) {
+        if (ServerThread && damdesc.pNpcAttacker && damdesc.pNpcAttacker != player && !IsNpcSimulatedLocally(damdesc.pNpcAttacker)) {
             Ivk_oCNpc_OnDamage_Sound(_this, damdesc);
             return;
         }
@@ -314,6 +324,22 @@ namespace GOTHIC_ENGINE {
         return Ivk_oCNpc_CanUse(_this, n);
     }
 
+    // NPCs inserted outside level loading (summons, scripted spawns) are named
+    // on the next frame, once the scripts have finished setting them up.
+    void __fastcall oCWorld_InsertVobInWorld(oCWorld*, void*, zCVob*);
+#if ENGINE >= Engine_G2
+    CInvoke<void(__thiscall*)(oCWorld*, zCVob*)> Ivk_oCWorld_InsertVobInWorld(0x00780330, &oCWorld_InsertVobInWorld);
+#else
+    CInvoke<void(__thiscall*)(oCWorld*, zCVob*)> Ivk_oCWorld_InsertVobInWorld(0x006D7120, &oCWorld_InsertVobInWorld);
+#endif
+    void __fastcall oCWorld_InsertVobInWorld(oCWorld* _this, void* vtable, zCVob* vob) {
+        Ivk_oCWorld_InsertVobInWorld(_this, vob);
+
+        if (!IsLoadingLevel && vob && vob->GetCharacterClass() == 2) {
+            QueueNpcRegistration((oCNpc*)vob);
+        }
+    }
+
     void __fastcall oCWorld_RemoveVob(oCWorld*, void*, zCVob*);
 #if ENGINE >= Engine_G2
     CInvoke<void(__thiscall*)(oCWorld*, zCVob*)> Ivk_oCWorld_RemoveVob(0x007800C0, &oCWorld_RemoveVob);
@@ -327,6 +353,8 @@ namespace GOTHIC_ENGINE {
 
         if (vob->GetCharacterClass() == 2) {
             auto npc = (oCNpc*)vob;
+            NpcGrid.Remove(npc);
+            UnqueueNpcRegistration(npc);
             if (npc && !IsCoopPlayer(npc->GetObjectName())) {
                 if (NpcToUniqueNameList.count(npc) > 0) {
                     auto uniqueName = NpcToUniqueNameList[npc];
@@ -387,12 +415,15 @@ namespace GOTHIC_ENGINE {
             return;
         }
 
-        if (!ClientThread || _this->homeVob == player) {
+        // Clients only play what the peers send; the host does so for the NPCs a client took over.
+        bool remoteControlled = ClientThread ||
+            (_this->homeVob && _this->homeVob->GetCharacterClass() == 2 && IsNpcPuppet((oCNpc*)_this->homeVob));
+        if (!remoteControlled || _this->homeVob == player) {
             Ivk_zCModel_StartAni(_this, a, b);
             return;
         }
 
-        if (ClientThread && b == COOP_MAGIC_NUMBER) {
+        if (b == COOP_MAGIC_NUMBER) {
             Ivk_zCModel_StartAni(_this, a, 0);
             return;
         }
@@ -404,18 +435,23 @@ namespace GOTHIC_ENGINE {
             return;
         }
 
-        if (ClientThread && _this->homeVob && _this->homeVob->GetCharacterClass() != 2) {
+        if (_this->homeVob && _this->homeVob->GetCharacterClass() != 2) {
+            Ivk_zCModel_StartAni(_this, a, b);
+            return;
+        }
+
+        if (IsNpcSimulatedLocally((oCNpc*)_this->homeVob)) {
             Ivk_zCModel_StartAni(_this, a, b);
             return;
         }
 
-        if (ClientThread && IsPlayerTalkingWithNpc(_this->homeVob)) {
+        if (IsPlayerTalkingWithNpc(_this->homeVob)) {
             Ivk_zCModel_StartAni(_this, a, b);
             return;
         }
 
         auto npc = (oCNpc*)_this->homeVob;
-        if (ClientThread && npc && IsNpcDead(npc)) {
+        if (npc && IsNpcDead(npc)) {
             Ivk_zCModel_StartAni(_this, a, b);
             return;
         }
@@ -0,0 +1,182 @@
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+namespace GOTHIC_ENGINE {
+    // Host only: which peers receive updates about each NPC, as a mask of
+    // friend id bits. A peer is added when its player comes within
+    // InterestRadius of the NPC and removed only past InterestRadius plus
+    // INTEREST_HYSTERESIS. NPCs not evaluated yet go to nobody.
+    struct InterestEntry {
+        std::uint64_t mask = 0;
+        long long seenMs = 0;
+    };
+    static std::map<string, InterestEntry> InterestEntries;
+    static long long LastInterestUpdateMs = 0;
+
+    struct InterestPeer {
+        int friendIdNumber;
+        zVEC3 position;
+        bool hasPosition;
+    };
+
+    std::uint64_t GetInterestMask(const string& npcName) {
+        auto it = InterestEntries.find(npcName);
+        return it != InterestEntries.end() ? it->second.mask : 0;
+    }
+
+    static void SendReleaseNpc(const string& npcName, int friendIdNumber) {
+        NetworkPacket packet;
+        packet.type = PacketType::PlayerStateUpdate;
+        packet.senderId = npcName.ToChar();
+        packet.recipientMask = 1ull << friendIdNumber;
+        packet.stateUpdate.updateType = RELEASE_NPC;
+        ReadyToSendPackets.enqueue(packet);
+    }
+
+    // Peers whose player position is not known yet are interested in everything.
+    // NPCs the grid found far from every peer skip the distance checks.
+    static void UpdateInterest(const string& npcName, const zVEC3& npcPosition, LocalNpc* localNpc, const std::vector<InterestPeer>& peers, bool nearPeers) {
+        auto& entry = InterestEntries[npcName];
+        entry.seenMs = CurrentMs;
+
+        std::uint64_t mask = 0;
+        for (auto& peer : peers) {
+            auto bit = 1ull << peer.friendIdNumber;
+            if (!peer.hasPosition) {
+                mask |= bit;
+                continue;
+            }
+            if (!nearPeers) {
+                continue;
+            }
+            float distance = GetVec3LengthApprox(peer.position - npcPosition);
+            float limit = (entry.mask & bit) ? InterestRadius + INTEREST_HYSTERESIS : static_cast<float>(InterestRadius);
+            if (distance <= limit) {
+                mask |= bit;
+            }
+        }
+
+        auto entered = mask & ~entry.mask;
+        auto left = entry.mask & ~mask;
+        entry.mask = mask;
+
+        // Client-owned NPCs are relayed as they come; the owner's next
+        // keyframe brings a peer that just entered up to date.
+        if (entered && localNpc) {
+            localNpc->interestSpawnMask |= entered;
+        }
+        for (auto& peer : peers) {
+            if (left & (1ull << peer.friendIdNumber)) {
+                SendReleaseNpc(npcName, peer.friendIdNumber);
+            }
+        }
+    }
+
+    // Re-evaluates every NPC the host sends or relays each INTEREST_UPDATE_MS,
+    // and NPCs that appeared since the last pass right away.
+    void UpdateInterestSets() {
+        if (!ServerThread) {
+            return;
+        }
+
+        bool due = CurrentMs >= LastInterestUpdateMs + INTEREST_UPDATE_MS;
+        if (due) {
+            LastInterestUpdateMs = CurrentMs;
+        }
+
+        std::vector<InterestPeer> peers;
+        for (auto friendIdNumber : ActiveFriendIds) {
+            if (friendIdNumber >= 64) {
+                continue;
+            }
+            InterestPeer peer;
+            peer.friendIdNumber = friendIdNumber;
+            peer.hasPosition = false;
+            auto syncIt = SyncNpcs.find(string::Combine("FRIEND_%i", friendIdNumber));
+            if (syncIt != SyncNpcs.end() && syncIt->second->lastPositionFromServer) {
+                peer.position = *syncIt->second->lastPositionFromServer;
+                peer.hasPosition = true;
+            }
+            peers.push_back(peer);
+        }
+
+        // One grid pass over the cells around all peers finds the NPCs any of
+        // them could be interested in. NPCs missing from the grid are checked
+        // one by one.
+        std::unordered_set<oCNpc*> nearPeers;
+        if (due) {
+            float points[64][3];
+            std::size_t pointCount = 0;
+            for (auto& peer : peers) {
+                if (peer.hasPosition) {
+                    points[pointCount][0] = peer.position.n[0];
+                    points[pointCount][1] = peer.position.n[1];
+                    points[pointCount][2] = peer.position.n[2];
+                    pointCount++;
+                }
+            }
+            float radius = InterestRadius + INTEREST_HYSTERESIS + INTEREST_GRID_SLACK;
+            NpcGrid.QueryAny(points, pointCount, radius, [&nearPeers](oCNpc* npc) {
+                nearPeers.insert(npc);
+            });
+        }
+        auto isNearPeers = [&](oCNpc* npc) {
+            return !due || !npc || !NpcGrid.Contains(npc) || nearPeers.count(npc) > 0;
+        };
+
+        for (auto& broadcastNpc : BroadcastNpcs) {
+            auto localNpc = broadcastNpc.second;
+            if (!localNpc->npc || (!due && InterestEntries.count(broadcastNpc.first))) {
+                continue;
+            }
+            UpdateInterest(broadcastNpc.first, localNpc->npc->GetPositionWorld(), localNpc, peers, isNearPeers(localNpc->npc));
+        }
+        for (auto& syncNpc : SyncNpcs) {
+            auto remoteNpc = syncNpc.second;
+            if (IsCoopPlayer(syncNpc.first) || remoteNpc->destroyed || !remoteNpc->lastPositionFromServer) {
+                continue;
+            }
+            if (!due && InterestEntries.count(syncNpc.first)) {
+                continue;
+            }
+            UpdateInterest(syncNpc.first, *remoteNpc->lastPositionFromServer, NULL, peers, isNearPeers(remoteNpc->npc));
+        }
+
+        if (!due) {
+            return;
+        }
+
+        InterestedNpcsPerPeer.clear();
+        for (auto it = InterestEntries.begin(); it != InterestEntries.end();) {
+            if (it->second.seenMs != CurrentMs) {
+                it = InterestEntries.erase(it);
+                continue;
+            }
+            for (auto& peer : peers) {
+                if (it->second.mask & (1ull << peer.friendIdNumber)) {
+                    InterestedNpcsPerPeer[peer.friendIdNumber]++;
+                }
+            }
+            ++it;
+        }
+    }
+
+    // A peer joined or left: it starts from an empty set, so everything it
+    // gets interested in is sent in full.
+    void ResetInterestPeer(int friendIdNumber) {
+        if (friendIdNumber < 0 || friendIdNumber >= 64) {
+            return;
+        }
+        for (auto& entry : InterestEntries) {
+            entry.second.mask &= ~(1ull << friendIdNumber);
+        }
+        InterestedNpcsPerPeer.erase(friendIdNumber);
+    }
+
+    void ClearInterestSets() {
+        InterestEntries.clear();
+        InterestedNpcsPerPeer.clear();
+        LastInterestUpdateMs = 0;
+    }
+}
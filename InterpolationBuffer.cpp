@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace GOTHIC_ENGINE {
+    zVEC3 Lerp(zVEC3 a, zVEC3 b, float t);
+
+    constexpr long long kInterpolationDefaultDelayMs = 100;
+    constexpr long long kInterpolationMinDelayMs = 50;
+    constexpr long long kInterpolationMaxDelayMs = 350;
+    // Updates further apart than this mean the sender stood still; the gap is
+    // not counted as jitter and motion restarts from the last known sample.
+    constexpr long long kInterpolationIdleGapMs = 400;
+    // Moves larger than this between two samples are teleports and are not blended.
+    constexpr float kInterpolationSnapDistance = 1500.0f;
+    // Past the newest sample positions are extrapolated with its velocity, but
+    // not for longer than this: senders refresh moving entities every second.
+    constexpr long long kInterpolationMaxExtrapolationMs = 1500;
+    constexpr std::size_t kInterpolationBufferSize = 32;
+
+    struct InterpolatedState {
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+        float heading = 0.0f;
+        bool hasPosition = false;
+        bool hasHeading = false;
+    };
+
+    // Keeps the last network samples of one remote entity, stamped with their
+    // arrival time, and renders them a little in the past so there is usually a
+    // pair of samples to blend between. The render delay follows the measured
+    // arrival interval and its jitter. Between sparse dead-reckoned updates the
+    // newest sample is extrapolated with its velocity.
+    class InterpolationBuffer {
+    public:
+        void AddPosition(long long nowMs, float x, float y, float z, float vx = 0.0f, float vy = 0.0f, float vz = 0.0f) {
+            if (positionCount > 0) {
+                auto newest = positions[(positionStart + positionCount - 1) % kInterpolationBufferSize];
+                float dx = x - newest.value[0];
+                float dy = y - newest.value[1];
+                float dz = z - newest.value[2];
+                if (std::sqrt(dx * dx + dy * dy + dz * dz) > kInterpolationSnapDistance) {
+                    positionCount = 0;
+                }
+                else {
+                    if (nowMs - newest.timeMs <= kInterpolationIdleGapMs) {
+                        MeasureInterval(nowMs - newest.timeMs);
+                    }
+
+                    // Blend from what is on screen right now rather than from the
+                    // newest sample when rendering had already run past it, or
+                    // from one interval ago after a long pause.
+                    long long restartMs = 0;
+                    if (lastRenderMs > newest.timeMs && lastRenderMs < nowMs) {
+                        restartMs = lastRenderMs;
+                    }
+                    else if (nowMs - newest.timeMs > kInterpolationIdleGapMs) {
+                        restartMs = nowMs - static_cast<long long>(meanIntervalMs);
+                    }
+                    if (restartMs > newest.timeMs) {
+                        Sample restart;
+                        restart.timeMs = restartMs;
+                        Extrapolate(newest, restartMs, restart.value);
+                        positionCount = 0;
+                        PushPosition(restart);
+                    }
+                }
+            }
+
+            Sample sample;
+            sample.timeMs = nowMs;
+            sample.value[0] = x;
+            sample.value[1] = y;
+            sample.value[2] = z;
+            sample.velocity[0] = vx;
+            sample.velocity[1] = vy;
+            sample.velocity[2] = vz;
+            PushPosition(sample);
+        }
+
+        void AddHeading(long long nowMs, float heading) {
+            if (headingCount > 0) {
+                auto& newest = headings[(headingStart + headingCount - 1) % kInterpolationBufferSize];
+                if (nowMs - newest.timeMs > kInterpolationIdleGapMs) {
+                    auto restart = newest;
+                    restart.timeMs = nowMs - static_cast<long long>(meanIntervalMs);
+                    headingCount = 0;
+                    PushHeading(restart);
+                }
+            }
+
+            Sample sample;
+            sample.timeMs = nowMs;
+            sample.value[0] = heading;
+            PushHeading(sample);
+        }
+
+        // Returns the state at nowMs minus the render delay. Before the oldest
+        // sample that sample is held; past the newest, the newest is extrapolated.
+        InterpolatedState Evaluate(long long nowMs) {
+            AdaptDelay();
+
+            InterpolatedState state;
+            long long renderMs = nowMs - static_cast<long long>(delayMs);
+            lastRenderMs = renderMs;
+
+            float position[3];
+            if (SampleRing(positions, positionStart, positionCount, renderMs, position, false)) {
+                state.x = position[0];
+                state.y = position[1];
+                state.z = position[2];
+                state.hasPosition = true;
+            }
+
+            float heading[3];
+            if (SampleRing(headings, headingStart, headingCount, renderMs, heading, true)) {
+                state.heading = heading[0];
+                state.hasHeading = true;
+            }
+            return state;
+        }
+
+        void Reset() {
+            positionStart = positionCount = 0;
+            headingStart = headingCount = 0;
+            meanIntervalMs = 50.0f;
+            jitterMs = 0.0f;
+            intervalSamples = 0;
+            delayMs = static_cast<float>(kInterpolationDefaultDelayMs);
+            lastRenderMs = 0;
+        }
+
+        int DelayMs() const {
+            return static_cast<int>(delayMs);
+        }
+
+    private:
+        struct Sample {
+            long long timeMs = 0;
+            float value[3] = { 0.0f, 0.0f, 0.0f };
+            float velocity[3] = { 0.0f, 0.0f, 0.0f };
+        };
+
+        static void Extrapolate(const Sample& sample, long long timeMs, float* out) {
+            long long aheadMs = std::min(std::max(timeMs - sample.timeMs, 0LL), kInterpolationMaxExtrapolationMs);
+            float seconds = aheadMs / 1000.0f;
+            for (int axis = 0; axis < 3; axis++) {
+                out[axis] = sample.value[axis] + sample.velocity[axis] * seconds;
+            }
+        }
+
+        static float Wrap360(float degrees) {
+            degrees = std::fmod(degrees, 360.0f);
+            return degrees < 0.0f ? degrees + 360.0f : degrees;
+        }
+
+        static float LerpAngle(float from, float to, float t) {
+            float delta = std::fmod(to - from + 540.0f, 360.0f) - 180.0f;
+            return Wrap360(from + delta * t);
+        }
+
+        void PushPosition(const Sample& sample) {
+            if (positionCount == kInterpolationBufferSize) {
+                positionStart = (positionStart + 1) % kInterpolationBufferSize;
+                positionCount--;
+            }
+            positions[(positionStart + positionCount) % kInterpolationBufferSize] = sample;
+            positionCount++;
+        }
+
+        void PushHeading(const Sample& sample) {
+            if (headingCount == kInterpolationBufferSize) {
+                headingStart = (headingStart + 1) % kInterpolationBufferSize;
+                headingCount--;
+            }
+            headings[(headingStart + headingCount) % kInterpolationBufferSize] = sample;
+            headingCount++;
+        }
+
+        // RFC 3550 style running estimates of the arrival interval and its deviation.
+        void MeasureInterval(long long intervalMs) {
+            float interval = static_cast<float>(intervalMs);
+            if (intervalSamples == 0) {
+                meanIntervalMs = interval;
+            }
+            else {
+                jitterMs += (std::fabs(interval - meanIntervalMs) - jitterMs) / 16.0f;
+                meanIntervalMs += (interval - meanIntervalMs) / 16.0f;
+            }
+            intervalSamples++;
+        }
+
+        // Enough delay to cover one interval plus the usual jitter, moved slowly
+        // so rendered time never jumps.
+        void AdaptDelay() {
+            float target = static_cast<float>(kInterpolationDefaultDelayMs);
+            if (intervalSamples >= 8) {
+                target = meanIntervalMs + 3.0f * jitterMs;
+                target = std::max(target, static_cast<float>(kInterpolationMinDelayMs));
+                target = std::min(target, static_cast<float>(kInterpolationMaxDelayMs));
+            }
+            delayMs += (target - delayMs) / 32.0f;
+        }
+
+        static bool SampleRing(const Sample* ring, std::size_t start, std::size_t count, long long renderMs, float* out, bool angle) {
+            if (count == 0) {
+                return false;
+            }
+
+            const Sample* older = &ring[start % kInterpolationBufferSize];
+            if (renderMs <= older->timeMs) {
+                std::copy(older->value, older->value + 3, out);
+                return true;
+            }
+
+            for (std::size_t i = 1; i < count; i++) {
+                const Sample* newer = &ring[(start + i) % kInterpolationBufferSize];
+                if (renderMs <= newer->timeMs) {
+                    long long span = newer->timeMs - older->timeMs;
+                    float t = span > 0 ? static_cast<float>(renderMs - older->timeMs) / span : 1.0f;
+                    if (angle) {
+                        out[0] = LerpAngle(older->value[0], newer->value[0], t);
+                    }
+                    else {
+                        auto blended = Lerp(zVEC3(older->value[0], older->value[1], older->value[2]),
+                            zVEC3(newer->value[0], newer->value[1], newer->value[2]), t);
+                        std::copy(blended.n, blended.n + 3, out);
+                    }
+                    return true;
+                }
+                older = newer;
+            }
+
+            Extrapolate(*older, renderMs, out);
+            return true;
+        }
+
+        Sample positions[kInterpolationBufferSize];
+        Sample headings[kInterpolationBufferSize];
+        std::size_t positionStart = 0;
+        std::size_t positionCount = 0;
+        std::size_t headingStart = 0;
+        std::size_t headingCount = 0;
+        float meanIntervalMs = 50.0f;
+        float jitterMs = 0.0f;
+        int intervalSamples = 0;
+        float delayMs = static_cast<float>(kInterpolationDefaultDelayMs);
+        long long lastRenderMs = 0;
+    };
+}
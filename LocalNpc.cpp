@@ -1,4 +1,6 @@
 namespace GOTHIC_ENGINE {
+    std::uint64_t GetInterestMask(const string& npcName);
+
     class LocalNpc
     {
     public:
@@ -10,15 +12,23 @@ namespace GOTHIC_ENGINE {
         std::list<int> pendingUpdates;
         std::list<PlayerHit> hitsToSync;
         std::list<SpellCast> spellCastsToSync;
-        struct PendingAnimationSync {
-            int animationId = 0;
-            zSTRING animationName;
-        };
-        std::vector<PendingAnimationSync> newAnimations;
+        AnimationStreamEntry recentAnimations[ANIMATION_STREAM_REDUNDANCY];
+        int recentAnimationCount = 0;
+        std::uint16_t animationSequence = 0;
+        int animationResendsLeft = 0;
         zCModelAni* lastAnimation;
-        zCArray<int> pArrOverlays;
+        OverlayTracker overlayTracker;
+        std::vector<std::uint8_t> lastOverlays;
         zVEC3 lastPosition;
+        zVEC3 lastVelocity;
+        long long lastPositionSentMs = 0;
+        zVEC3 sampledPosition;
+        zVEC3 sampledVelocity;
+        long long sampledPositionMs = 0;
+        bool positionSettlePending = false;
         float lastHeading = 0;
+        long long nextKeyframeMs = 0;
+        bool keyframeDue = false;
         int lastWeaponMode;
         int lastSyncHp = -1;
         int lastSyncMaxHp;
@@ -35,6 +45,11 @@ namespace GOTHIC_ENGINE {
         zSTRING pendingRightHandInstanceName;
         zSTRING revivedFriend = "";
         long long lastTimeSyncTime = 0;
+        long long nextBroadcastPulseMs = 0;
+        long long lastBroadcastPulseMs = 0;
+        bool broadcastInCombat = false;
+        // Host only: peers that just got interested in this NPC and need its full state.
+        std::uint64_t interestSpawnMask = 0;
         long long lastHandChangeTime = 0;
         oCItem* pItemDropped = NULL;
         oCItem* pItemTaken = NULL;
@@ -52,6 +67,16 @@ namespace GOTHIC_ENGINE {
             }
 
             hasModel = npc && npc->GetModel() && npc->vobLeafList.GetNum() > 0;
+
+            // Keyframes are staggered so entities do not all resend in one frame.
+            static int keyframeSlot = 0;
+            if (nextKeyframeMs == 0) {
+                nextKeyframeMs = CurrentMs + (keyframeSlot++ * 97) % TRANSFORM_KEYFRAME_MS;
+            }
+            keyframeDue = CurrentMs >= nextKeyframeMs;
+            if (keyframeDue) {
+                nextKeyframeMs = CurrentMs + TRANSFORM_KEYFRAME_MS;
+            }
  
             this->SyncInitialization();
             //this->SyncBodystate();
@@ -85,7 +110,13 @@ namespace GOTHIC_ENGINE {
         void Reinit() {
             initialized = false;
             lastPosition = NULL;
+            lastVelocity = zVEC3(0, 0, 0);
+            lastPositionSentMs = 0;
+            sampledPositionMs = 0;
+            sampledVelocity = zVEC3(0, 0, 0);
+            positionSettlePending = false;
             lastHeading = 0;
+            nextKeyframeMs = 0;
             lastWeaponMode = 0;
             lastSyncHp = -1;
             lastSyncMaxHp = 0;
@@ -116,13 +147,11 @@ namespace GOTHIC_ENGINE {
             itemDropReady = false;
             pItemTaken = NULL;
             pItemTakenPos = zVEC3(0, 0, 0);
-            pArrOverlays.DeleteList();
+            overlayTracker.Reset();
+            lastOverlays.clear();
             
             if (lastAnimation) {
-                PendingAnimationSync pending;
-                pending.animationId = lastAnimation->aniID;
-                pending.animationName = lastAnimation->aniName;
-                newAnimations.push_back(pending);
+                RecordAnimation(lastAnimation->aniID);
             }
         }
 
@@ -133,24 +162,58 @@ namespace GOTHIC_ENGINE {
             }
         }
 
+        // Dead reckoning: receivers extrapolate the last sent position with the
+        // last sent velocity, so a new position is only needed once that guess
+        // drifts past PositionErrorThreshold. Moving NPCs are refreshed once a
+        // second because the receiver stops extrapolating after a while, and a
+        // stop is sent twice since position updates are unreliable. Keyframes
+        // repair whatever was lost anyway.
         void SyncPosition()
         {
             zVEC3 playerPos = npc->GetPositionWorld();
 
-            float dist = lastPosition != NULL ?
-                GetDistance3D(playerPos.n[0], playerPos.n[1], playerPos.n[2], lastPosition.n[0], lastPosition.n[1], lastPosition.n[2]) :
-                999.0f;
+            if (sampledPositionMs > 0 && CurrentMs > sampledPositionMs) {
+                float seconds = (CurrentMs - sampledPositionMs) / 1000.0f;
+                for (int i = 0; i < 3; i++) {
+                    float velocity = (playerPos.n[i] - sampledPosition.n[i]) / seconds;
+                    sampledVelocity.n[i] += (velocity - sampledVelocity.n[i]) * 0.5f;
+                }
+            }
+            sampledPosition = playerPos;
+            sampledPositionMs = CurrentMs;
+
+            float speed = GetDistance3D(sampledVelocity.n[0], sampledVelocity.n[1], sampledVelocity.n[2], 0, 0, 0);
+            bool moving = speed > DEAD_RECKONING_MIN_SPEED && speed < kMaxVelocity;
+            long long sinceSent = CurrentMs - lastPositionSentMs;
+
+            bool send = lastPosition == NULL;
+            if (!send) {
+                float seconds = sinceSent / 1000.0f;
+                float predictedX = lastPosition.n[0] + lastVelocity.n[0] * seconds;
+                float predictedY = lastPosition.n[1] + lastVelocity.n[1] * seconds;
+                float predictedZ = lastPosition.n[2] + lastVelocity.n[2] * seconds;
+                float error = GetDistance3D(playerPos.n[0], playerPos.n[1], playerPos.n[2], predictedX, predictedY, predictedZ);
 
-            if (dist > 5.0f)
+                send = error > PositionErrorThreshold
+                    || (moving && sinceSent > DEAD_RECKONING_REFRESH_MS)
+                    || (positionSettlePending && sinceSent > DEAD_RECKONING_SETTLE_MS)
+                    || keyframeDue;
+            }
+
+            if (send)
             {
+                bool wasMoving = lastVelocity.n[0] != 0 || lastVelocity.n[1] != 0 || lastVelocity.n[2] != 0;
                 addUpdate(SYNC_POS);
                 lastPosition = playerPos;
+                lastVelocity = moving ? sampledVelocity : zVEC3(0, 0, 0);
+                lastPositionSentMs = CurrentMs;
+                positionSettlePending = wasMoving && !moving;
             }
         };
 
         void SyncAngle() {
             float currentHeading = GetHeading(npc);
-            if (abs(currentHeading - lastHeading) > 3)
+            if (abs(currentHeading - lastHeading) > 3 || keyframeDue)
             {
                 addUpdate(SYNC_HEADING);
                 lastHeading = currentHeading;
@@ -169,19 +232,34 @@ namespace GOTHIC_ENGINE {
             }
 
             if (currentLastAnim != lastAnimation) {
-                PendingAnimationSync pending;
-                pending.animationId = currentLastAnim->aniID;
-                pending.animationName = currentLastAnim->aniName;
-                newAnimations.push_back(pending);
+                RecordAnimation(currentLastAnim->aniID);
                 lastAnimation = currentLastAnim;
             }
 
-            if (!newAnimations.empty())
+            // The stream is unreliable, so the newest animations go out on a
+            // few more ticks after the last change.
+            if (animationResendsLeft > 0)
             {
+                animationResendsLeft--;
                 addUpdate(SYNC_ANIMATION);
             }
         }
 
+        void RecordAnimation(int animationId) {
+            if (recentAnimationCount == ANIMATION_STREAM_REDUNDANCY) {
+                for (int i = 1; i < recentAnimationCount; i++) {
+                    recentAnimations[i - 1] = recentAnimations[i];
+                }
+                recentAnimationCount--;
+            }
+
+            auto& entry = recentAnimations[recentAnimationCount++];
+            entry.animationId = animationId;
+            entry.startTick = static_cast<std::uint32_t>(CurrentMs);
+            animationSequence++;
+            animationResendsLeft = ANIMATION_STREAM_RESENDS + 1;
+        }
+
         void SyncWeaponMode() {
             int currentWeaponMode = npc->GetWeaponMode();
             if (currentWeaponMode != lastWeaponMode) {
@@ -284,10 +362,11 @@ namespace GOTHIC_ENGINE {
         }
 
         void SyncOverlays() {
-            if (!npc->CompareOverlaysArray(pArrOverlays))
+            const auto& overlays = overlayTracker.Get(npc);
+            if (overlays != lastOverlays)
             {
                 addUpdate(SYNC_OVERLAYS);
-                pArrOverlays = GetNpcMds(npc);
+                lastOverlays = overlays;
             }
         }
 
@@ -395,18 +474,80 @@ namespace GOTHIC_ENGINE {
             }
         }
 
+        bool GetSnapshotState(EntitySnapshotState& state) {
+            if (destroyed || !initialized || lastSyncHp < 0) {
+                return false;
+            }
+
+            state.pos.x = lastPosition.n[0];
+            state.pos.y = lastPosition.n[1];
+            state.pos.z = lastPosition.n[2];
+            state.pos.vx = lastVelocity.n[0];
+            state.pos.vy = lastVelocity.n[1];
+            state.pos.vz = lastVelocity.n[2];
+            state.heading.heading = lastHeading;
+            state.weaponMode.weaponMode = lastWeaponMode;
+            state.hp.hp = lastSyncHp;
+            state.hp.hpMax = lastSyncMaxHp;
+
+            if (npc == player) {
+                for (int i = 0; i < 8; i++) {
+                    state.protections.protections[i] = lastProtections[i];
+                }
+                for (int i = 0; i < 4; i++) {
+                    state.talents.talents[i] = lastTalents[i];
+                }
+            }
+            return true;
+        }
+
         void PackUpdate() {
+            // The host sends NPCs only to the peers interested in them; players go to everybody.
+            bool filtered = ServerThread && npc != player;
+            std::uint64_t recipientMask = filtered ? GetInterestMask(name) : 0;
+
             for each (auto type in pendingUpdates)
             {
+                if (SnapshotReplication && IsSnapshotReplicatedUpdate(type)) {
+                    continue;
+                }
+
                 NetworkPacket packet;
                 packet.type = PacketType::PlayerStateUpdate;
-                packet.senderId = ServerThread ? std::string(name.ToChar()) : std::string();
+                // Clients send their own player without a name, the host fills it in.
+                packet.senderId = (ServerThread || npc != player) ? std::string(name.ToChar()) : std::string();
+                packet.recipientMask = recipientMask;
                 packet.stateUpdate.updateType = static_cast<UpdateType>(type);
                 this->AddUpdatePayload(type, packet.stateUpdate);
-                ReadyToSendPackets.enqueue(packet);
+                if (!filtered || recipientMask != 0) {
+                    ReadyToSendPackets.enqueue(packet);
+                }
             }
 
             pendingUpdates.clear();
+
+            if (interestSpawnMask != 0) {
+                PackSpawnState(interestSpawnMask);
+                interestSpawnMask = 0;
+            }
+        }
+
+        // Everything a peer needs to show this NPC after it was released for it.
+        void PackSpawnState(std::uint64_t recipientMask) {
+            static const int spawnTypes[] = { SYNC_POS, SYNC_HEADING, SYNC_WEAPON_MODE, SYNC_HP, SYNC_MAGIC_SETUP, SYNC_OVERLAYS };
+            for (auto type : spawnTypes) {
+                if (type == SYNC_HP && lastSyncHp < 0) {
+                    continue;
+                }
+
+                NetworkPacket packet;
+                packet.type = PacketType::PlayerStateUpdate;
+                packet.senderId = name.ToChar();
+                packet.recipientMask = recipientMask;
+                packet.stateUpdate.updateType = static_cast<UpdateType>(type);
+                this->AddUpdatePayload(type, packet.stateUpdate);
+                ReadyToSendPackets.enqueue(packet);
+            }
         }
 
         void AddUpdatePayload(int type, PlayerStateUpdatePacket& packet) {
@@ -431,6 +572,9 @@ namespace GOTHIC_ENGINE {
                     packet.pos.x = lastPosition.n[0];
                     packet.pos.y = lastPosition.n[1];
                     packet.pos.z = lastPosition.n[2];
+                    packet.pos.vx = lastVelocity.n[0];
+                    packet.pos.vy = lastVelocity.n[1];
+                    packet.pos.vz = lastVelocity.n[2];
                     break;
                 }
                 case SYNC_HEADING:
@@ -440,12 +584,8 @@ namespace GOTHIC_ENGINE {
                 }
                 case SYNC_ANIMATION:
                 {
-                    if (!newAnimations.empty()) {
-                        auto pending = newAnimations.back();
-                        newAnimations.pop_back();
-                        packet.animation.animationId = pending.animationId;
-                        packet.animation.animationName = pending.animationName.ToChar();
-                    }
+                    packet.animation.sequence = animationSequence;
+                    packet.animation.entries.assign(recentAnimations, recentAnimations + recentAnimationCount);
                     break;
                 }
                 case SYNC_WEAPON_MODE:
@@ -461,16 +601,17 @@ namespace GOTHIC_ENGINE {
                 case SYNC_SPELL_CAST:
                 {
                     auto casts = nlohmann::json::array();
-                    for each (auto sc in spellCastsToSync) {
+                    // Anything past the packet limit goes out on the next tick.
+                    while (!spellCastsToSync.empty() && packet.spellCasts.casts.size() < kMaxSpellCastCount) {
+                        auto& sc = spellCastsToSync.front();
                         SpellCastInfo cast;
                         cast.target = sc.targetNpcUniqueName.ToChar();
                         cast.spellInstanceId = sc.spellInstanceId;
                         cast.spellLevel = sc.spellLevel;
                         cast.spellCharge = sc.spellCharge;
                         packet.spellCasts.casts.push_back(cast);
+                        spellCastsToSync.pop_front();
                     }
-
-                    spellCastsToSync.clear();
                     break;
                 }
                 case SYNC_ARMOR:
@@ -497,11 +638,7 @@ namespace GOTHIC_ENGINE {
                 }
                 case SYNC_OVERLAYS:
                 {
-                    for (int i = 0; i < pArrOverlays.GetNumInList(); i++)
-                    {
-                        packet.overlays.overlayIds.push_back(pArrOverlays.GetSafe(i));
-                    }
-    
+                    packet.overlays.overlays = lastOverlays;
                     break;
                 }
                 case SYNC_PROTECTIONS:
@@ -540,7 +677,9 @@ namespace GOTHIC_ENGINE {
                 }
                 case SYNC_ATTACKS:
                 {
-                    for each (auto at in hitsToSync) {
+                    // Anything past the packet limit goes out on the next tick.
+                    while (!hitsToSync.empty() && packet.attacks.attacks.size() < kMaxAttackCount) {
+                        auto& at = hitsToSync.front();
                         AttackInfo attack;
                         attack.target = at.npcUniqueName.ToChar();
                         attack.damage = at.damage;
@@ -549,9 +688,8 @@ namespace GOTHIC_ENGINE {
                         attack.isFinish = at.isFinish;
                         attack.damageMode = at.damageMode;
                         packet.attacks.attacks.push_back(attack);
+                        hitsToSync.pop_front();
                     }
-
-                    hitsToSync.clear();
                     break;
                 }
                 case SYNC_DROPITEM:
@@ -0,0 +1,18 @@
+#include "NetCore/NetCore.h"
+
+#include <cstdio>
+
+namespace NetCore {
+    void CoopLog(std::string text) {
+        std::fputs(text.c_str(), stderr);
+    }
+
+    int GetEmulationKeyCode(string code) {
+        return code.rfind("KEY_", 0) == 0 || code.rfind("MOUSE_", 0) == 0 ? 1 : 0;
+    }
+}
+
+#include "NetworkPackets.cpp"
+#include "StateSnapshots.cpp"
+#include "NetTransport.cpp"
+#include "Config.cpp"
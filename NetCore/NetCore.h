@@ -0,0 +1,30 @@
+// Engine-independent part of the plugin: packet format, snapshot delta coding,
+// transport glue, the thread-safe queue and the config loader. Built as the netcore static library
+// for the Linux tooling; the plugin DLL still compiles the same sources per
+// engine through Sources.h.
+#pragma once
+
+#define GOTHIC_ENGINE NetCore
+#define Engine_G1  1
+#define Engine_G1A 2
+#define Engine_G2  3
+#define Engine_G2A 4
+#define ENGINE Engine_G2A
+
+#include <enet/enet.h>
+#include <string>
+
+namespace NetCore {
+    typedef std::string string;
+
+    // Stand-ins for the engine side. CoopLog writes to stderr and key names are
+    // only checked for a KEY_ or MOUSE_ prefix, since the key tables live in Union.
+    void CoopLog(std::string text);
+    int GetEmulationKeyCode(string code);
+}
+
+#include "SafeQueue.cpp"
+#include "NetworkPackets.h"
+#include "StateSnapshots.h"
+#include "NetTransport.h"
+#include "Config.h"
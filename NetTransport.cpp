@@ -0,0 +1,53 @@
+namespace GOTHIC_ENGINE {
+    ENetPacketFlag PacketFlag(const NetworkPacket& packet) {
+        if (packet.type == PacketType::StateSnapshot || packet.type == PacketType::SnapshotAck) {
+            return ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT;
+        }
+
+        if (packet.type == PacketType::PlayerStateUpdate) {
+            auto updateType = packet.stateUpdate.updateType;
+            if (updateType == SYNC_POS || updateType == SYNC_HEADING) {
+                return ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT;
+            }
+            // Unreliable and sequenced: ENet drops late arrivals on the channel,
+            // and every packet repeats the last few animations.
+            if (updateType == SYNC_ANIMATION) {
+                return static_cast<ENetPacketFlag>(0);
+            }
+        }
+
+        return ENET_PACKET_FLAG_RELIABLE;
+    }
+
+    int PacketChannel(const NetworkPacket& packet) {
+        if (packet.type == PacketType::StateSnapshot || packet.type == PacketType::SnapshotAck) {
+            return 1;
+        }
+
+        if (packet.type == PacketType::PlayerStateUpdate) {
+            auto updateType = packet.stateUpdate.updateType;
+            if (updateType == SYNC_POS || updateType == SYNC_HEADING) {
+                return 1;
+            }
+            if (updateType == SYNC_ANIMATION) {
+                return 2;
+            }
+        }
+
+        return 0;
+    }
+
+    // Serializes the packet into payload and wraps it with the flags for its type.
+    // The payload is left in place for the capture. Returns NULL on failure.
+    ENetPacket* CreateEnetPacket(const NetworkPacket& packet, std::vector<std::uint8_t>& payload, std::string& error) {
+        if (!SerializeNetworkPacket(packet, payload, error)) {
+            return NULL;
+        }
+
+        ENetPacket* enetPacket = enet_packet_create(payload.data(), payload.size(), PacketFlag(packet));
+        if (!enetPacket) {
+            error = "Unable to allocate ENet packet.";
+        }
+        return enetPacket;
+    }
+}
@@ -0,0 +1,10 @@
+#include <enet/enet.h>
+
+namespace GOTHIC_ENGINE {
+    // 0: reliable events, 1: unreliable state, 2: unreliable sequenced animations.
+    constexpr std::size_t kNetworkChannelCount = 3;
+
+    ENetPacketFlag PacketFlag(const NetworkPacket& packet);
+    int PacketChannel(const NetworkPacket& packet);
+    ENetPacket* CreateEnetPacket(const NetworkPacket& packet, std::vector<std::uint8_t>& payload, std::string& error);
+}
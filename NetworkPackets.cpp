@@ -1,198 +1,8 @@
-#include <cstdint>
-#include <vector>
-#include <string>
 #include <sstream>
 #include <cmath>
-#include <cstring>
+#include <algorithm>
 
 namespace GOTHIC_ENGINE {
-    enum class PacketType : std::uint8_t {
-        JoinGame = 1,
-        PlayerDisconnect = 2,
-        PlayerStateUpdate = 3,
-    };
-
-    struct JoinGamePacket {
-        std::uint32_t connectId = 0;
-        std::string name;
-    };
-
-    struct PlayerDisconnectPacket {
-        std::string name;
-        std::string nickname;
-        bool hasNickname = false;
-    };
-
-    struct InitNpcPayload {
-        int instanceId = 0;
-        std::string nickname;
-        float x = 0.0f;
-        float y = 0.0f;
-        float z = 0.0f;
-        std::string bodyModel;
-        int BodyTex = 0;
-        int BodyColor = 0;
-        std::string headModel;
-        int HeadTex = 0;
-    };
-
-    struct SyncPosPayload {
-        float x = 0.0f;
-        float y = 0.0f;
-        float z = 0.0f;
-    };
-
-    struct SyncHeadingPayload {
-        float heading = 0.0f;
-    };
-
-    struct SyncAnimationPayload {
-        int animationId = 0;
-        std::string animationName;
-    };
-
-    struct SyncWeaponModePayload {
-        int weaponMode = 0;
-    };
-
-    struct SyncMagicSetupPayload {
-        std::string spellInstanceName;
-    };
-
-    struct SpellCastInfo {
-        std::string target;
-        int spellInstanceId = 0;
-        int spellLevel = 0;
-        int spellCharge = 0;
-    };
-
-    struct SyncSpellCastPayload {
-        std::vector<SpellCastInfo> casts;
-    };
-
-    struct SyncArmorPayload {
-        std::string armor;
-    };
-
-    struct SyncWeaponsPayload {
-        std::string weapon1;
-        std::string weapon2;
-    };
-
-    struct SyncHpPayload {
-        int hp = 0;
-        int hpMax = 0;
-    };
-
-    struct SyncBodyStatePayload {
-        int bodyState = 0;
-    };
-
-    struct SyncOverlaysPayload {
-        std::vector<int> overlayIds;
-    };
-
-    struct SyncProtectionsPayload {
-        int protections[8] = {0};
-    };
-
-    struct SyncTalentsPayload {
-        int talents[4] = {0};
-    };
-
-    struct SyncHandPayload {
-        std::string leftItem;
-        std::string rightItem;
-    };
-
-    struct SyncTimePayload {
-        float rawTime = 0.0f;
-    };
-
-    struct SyncRevivedPayload {
-        std::string name;
-    };
-
-    struct AttackInfo {
-        std::string target;
-        float damage = 0.0f;
-        int isUnconscious = 0;
-        bool isDead = false;
-        bool isFinish = false;
-        unsigned long damageMode = 0;
-    };
-
-    struct SyncAttacksPayload {
-        std::vector<AttackInfo> attacks;
-    };
-
-    struct SyncDropItemPayload {
-        std::string itemDropped;
-        int count = 0;
-        int flags = 0;
-        std::string itemUniqueName;
-    };
-
-    struct SyncTakeItemPayload {
-        std::string itemDropped;
-        int count = 0;
-        int flags = 0;
-        std::string uniqueName;
-        float x = 0.0f;
-        float y = 0.0f;
-        float z = 0.0f;
-    };
-
-    struct PlayerStateUpdatePacket {
-        UpdateType updateType = SYNC_POS;
-        InitNpcPayload initNpc;
-        SyncPosPayload pos;
-        SyncHeadingPayload heading;
-        SyncAnimationPayload animation;
-        SyncWeaponModePayload weaponMode;
-        SyncMagicSetupPayload magicSetup;
-        SyncSpellCastPayload spellCasts;
-        SyncArmorPayload armor;
-        SyncWeaponsPayload weapons;
-        SyncHpPayload hp;
-        SyncBodyStatePayload bodyState;
-        SyncOverlaysPayload overlays;
-        SyncProtectionsPayload protections;
-        SyncTalentsPayload talents;
-        SyncHandPayload hand;
-        SyncTimePayload time;
-        SyncRevivedPayload revived;
-        SyncAttacksPayload attacks;
-        SyncDropItemPayload dropItem;
-        SyncTakeItemPayload takeItem;
-    };
-
-    struct NetworkPacket {
-        PacketType type = PacketType::PlayerStateUpdate;
-        std::string senderId;
-        JoinGamePacket joinGame;
-        PlayerDisconnectPacket disconnect;
-        PlayerStateUpdatePacket stateUpdate;
-    };
-
-    enum class PacketDecodeMode {
-        Client,
-        Server,
-    };
-
-    constexpr std::uint8_t kNetworkPacketVersion = 3;
-    constexpr std::size_t kMaxPacketBytes = 16384;
-    constexpr std::size_t kMaxNameLength = 64;
-    constexpr std::size_t kMaxNicknameLength = 32;
-    constexpr std::size_t kMaxInstanceNameLength = 64;
-    constexpr std::size_t kMaxUniqueNameLength = 96;
-    constexpr std::size_t kMaxOverlayCount = 96;
-    constexpr std::size_t kMaxSpellCastCount = 32;
-    constexpr std::size_t kMaxAttackCount = 32;
-    constexpr std::size_t kMaxAnimationNameLength = 64;
-    constexpr int kMinSkinColor = 0;
-    constexpr int kMaxSkinColor = 3;
-
     static bool IsFinite(float value) {
         return std::isfinite(value);
     }
@@ -201,178 +11,189 @@ namespace GOTHIC_ENGINE {
         return c >= 32 && c <= 126;
     }
 
-    static bool SanitizeServerText(std::string& text, std::size_t maxLen) {
-        std::string sanitized;
-        sanitized.reserve(text.size());
-        for (unsigned char c : text) {
-            if (IsPrintableServerChar(c)) {
-                sanitized.push_back(static_cast<char>(c));
+    // Checks eight bytes per step: a byte is flagged if it is below 0x20 or above 0x7E.
+    bool IsPrintableServerText(std::string_view text) {
+        constexpr std::uint64_t kOnes = 0x0101010101010101ull;
+        constexpr std::uint64_t kHighBits = 0x8080808080808080ull;
+
+        const char* data = text.data();
+        std::size_t size = text.size();
+        std::size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            std::uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            std::uint64_t below = (word - kOnes * 0x20) & ~word;
+            std::uint64_t above = (word + kOnes) | word;
+            if ((below | above) & kHighBits) {
+                return false;
             }
         }
-        if (sanitized.size() > maxLen) {
-            sanitized.resize(maxLen);
-        }
-        if (sanitized.empty() && !text.empty()) {
-            return false;
+        for (; i < size; ++i) {
+            if (!IsPrintableServerChar(static_cast<unsigned char>(data[i]))) {
+                return false;
+            }
         }
-        text = sanitized;
         return true;
     }
 
-    class PacketWriter {
-    public:
-        bool writeU8(std::uint8_t value) {
-            buffer.push_back(value);
+    bool SanitizeServerText(std::string& text, std::size_t maxLen) {
+        if (IsPrintableServerText(text)) {
+            if (text.size() > maxLen) {
+                text.resize(maxLen);
+            }
             return true;
         }
 
-        bool writeU16(std::uint16_t value) {
-            buffer.push_back(static_cast<std::uint8_t>(value & 0xFF));
-            buffer.push_back(static_cast<std::uint8_t>((value >> 8) & 0xFF));
-            return true;
+        bool wasEmpty = text.empty();
+        text.erase(std::remove_if(text.begin(), text.end(), [](char c) {
+            return !IsPrintableServerChar(static_cast<unsigned char>(c));
+        }), text.end());
+        if (text.size() > maxLen) {
+            text.resize(maxLen);
         }
+        return !(text.empty() && !wasEmpty);
+    }
 
-        bool writeU32(std::uint32_t value) {
-            for (int i = 0; i < 4; ++i) {
-                buffer.push_back(static_cast<std::uint8_t>((value >> (8 * i)) & 0xFF));
-            }
-            return true;
-        }
+    static bool ValidateRange(int value, int minValue, int maxValue) {
+        return value >= minValue && value <= maxValue;
+    }
 
-        bool writeI32(std::int32_t value) {
-            return writeU32(static_cast<std::uint32_t>(value));
-        }
+    static bool ValidateRangeFloat(float value, float minValue, float maxValue) {
+        return IsFinite(value) && value >= minValue && value <= maxValue;
+    }
 
-        bool writeBool(bool value) {
-            return writeU8(value ? 1 : 0);
+    // Validates in the packet buffer and copies once; only text that actually
+    // contains unprintable characters is compacted afterwards.
+    static bool ReadSanitizedText(PacketReader& reader, std::string& out, std::size_t maxLen, bool sanitizeText) {
+        std::string_view view;
+        if (!reader.readStringView(view, maxLen)) {
+            return false;
         }
-
-        bool writeFloat(float value) {
-            static_assert(sizeof(float) == sizeof(std::uint32_t), "Unexpected float size.");
-            std::uint32_t raw;
-            std::memcpy(&raw, &value, sizeof(raw));
-            return writeU32(raw);
+        out.assign(view.data(), view.size());
+        if (sanitizeText && !IsPrintableServerText(view)) {
+            return SanitizeServerText(out, maxLen);
         }
+        return true;
+    }
 
-        bool writeString(const std::string& value, std::size_t maxLen) {
-            if (value.size() > maxLen) {
-                return false;
-            }
-            if (!writeU16(static_cast<std::uint16_t>(value.size()))) {
-                return false;
+    std::size_t SnapshotEntityWireSize(const EntitySnapshot& entity) {
+        std::size_t size = 2 + entity.name.size() + 2;
+        if (entity.fieldMask & SNAPSHOT_POS) size += 24;
+        if (entity.fieldMask & SNAPSHOT_HEADING) size += 4;
+        if (entity.fieldMask & SNAPSHOT_WEAPON_MODE) size += 4;
+        if (entity.fieldMask & SNAPSHOT_HP) size += 8;
+        if (entity.fieldMask & SNAPSHOT_PROTECTIONS) size += 32;
+        if (entity.fieldMask & SNAPSHOT_TALENTS) size += 16;
+        return size;
+    }
+
+    static void WriteSnapshotState(PacketWriter& writer, const EntitySnapshotState& state, std::uint16_t fieldMask) {
+        if (fieldMask & SNAPSHOT_POS) {
+            writer.writeFloat(state.pos.x);
+            writer.writeFloat(state.pos.y);
+            writer.writeFloat(state.pos.z);
+            writer.writeFloat(state.pos.vx);
+            writer.writeFloat(state.pos.vy);
+            writer.writeFloat(state.pos.vz);
+        }
+        if (fieldMask & SNAPSHOT_HEADING) {
+            writer.writeFloat(state.heading.heading);
+        }
+        if (fieldMask & SNAPSHOT_WEAPON_MODE) {
+            writer.writeI32(state.weaponMode.weaponMode);
+        }
+        if (fieldMask & SNAPSHOT_HP) {
+            writer.writeI32(state.hp.hp);
+            writer.writeI32(state.hp.hpMax);
+        }
+        if (fieldMask & SNAPSHOT_PROTECTIONS) {
+            for (int i = 0; i < 8; ++i) {
+                writer.writeI32(state.protections.protections[i]);
             }
-            buffer.insert(buffer.end(), value.begin(), value.end());
-            return true;
         }
-
-        const std::vector<std::uint8_t>& data() const { return buffer; }
-
-    private:
-        std::vector<std::uint8_t> buffer;
-    };
-
-    class PacketReader {
-    public:
-        PacketReader(const std::uint8_t* data, std::size_t size)
-            : data(data)
-            , size(size)
-            , offset(0) {}
-
-        bool readU8(std::uint8_t& value) {
-            if (offset + 1 > size) {
-                return false;
+        if (fieldMask & SNAPSHOT_TALENTS) {
+            for (int i = 0; i < 4; ++i) {
+                writer.writeI32(state.talents.talents[i]);
             }
-            value = data[offset];
-            offset += 1;
-            return true;
         }
+    }
 
-        bool readU16(std::uint16_t& value) {
-            if (offset + 2 > size) {
+    static bool ReadSnapshotState(PacketReader& reader, EntitySnapshotState& state, std::uint16_t fieldMask, std::string& error) {
+        if (fieldMask & SNAPSHOT_POS) {
+            if (!reader.readFloat(state.pos.x)
+                || !reader.readFloat(state.pos.y)
+                || !reader.readFloat(state.pos.z)
+                || !reader.readFloat(state.pos.vx)
+                || !reader.readFloat(state.pos.vy)
+                || !reader.readFloat(state.pos.vz)) {
+                error = "Invalid snapshot position.";
                 return false;
             }
-            value = static_cast<std::uint16_t>(data[offset])
-                | (static_cast<std::uint16_t>(data[offset + 1]) << 8);
-            offset += 2;
-            return true;
-        }
-
-        bool readU32(std::uint32_t& value) {
-            if (offset + 4 > size) {
+            if (!ValidateRangeFloat(state.pos.x, -kMaxCoordinate, kMaxCoordinate)
+                || !ValidateRangeFloat(state.pos.y, -kMaxCoordinate, kMaxCoordinate)
+                || !ValidateRangeFloat(state.pos.z, -kMaxCoordinate, kMaxCoordinate)
+                || !ValidateRangeFloat(state.pos.vx, -kMaxVelocity, kMaxVelocity)
+                || !ValidateRangeFloat(state.pos.vy, -kMaxVelocity, kMaxVelocity)
+                || !ValidateRangeFloat(state.pos.vz, -kMaxVelocity, kMaxVelocity)) {
+                error = "Snapshot position out of range.";
                 return false;
             }
-            value = static_cast<std::uint32_t>(data[offset])
-                | (static_cast<std::uint32_t>(data[offset + 1]) << 8)
-                | (static_cast<std::uint32_t>(data[offset + 2]) << 16)
-                | (static_cast<std::uint32_t>(data[offset + 3]) << 24);
-            offset += 4;
-            return true;
         }
-
-        bool readI32(std::int32_t& value) {
-            std::uint32_t raw = 0;
-            if (!readU32(raw)) {
+        if (fieldMask & SNAPSHOT_HEADING) {
+            if (!reader.readFloat(state.heading.heading)) {
+                error = "Invalid snapshot heading.";
                 return false;
             }
-            value = static_cast<std::int32_t>(raw);
-            return true;
-        }
-
-        bool readBool(bool& value) {
-            std::uint8_t raw = 0;
-            if (!readU8(raw)) {
+            if (!ValidateRangeFloat(state.heading.heading, -360.0f, 360.0f)) {
+                error = "Snapshot heading out of range.";
                 return false;
             }
-            value = raw != 0;
-            return true;
         }
-
-        bool readFloat(float& value) {
-            std::uint32_t raw = 0;
-            if (!readU32(raw)) {
+        if (fieldMask & SNAPSHOT_WEAPON_MODE) {
+            if (!reader.readI32(state.weaponMode.weaponMode)) {
+                error = "Invalid snapshot weapon mode.";
                 return false;
             }
-            std::memcpy(&value, &raw, sizeof(raw));
-            return true;
-        }
-
-        bool readString(std::string& value, std::size_t maxLen) {
-            std::uint16_t length = 0;
-            if (!readU16(length)) {
+            if (!ValidateRange(state.weaponMode.weaponMode, 0, 100)) {
+                error = "Snapshot weapon mode out of range.";
                 return false;
             }
-            if (length > maxLen) {
+        }
+        if (fieldMask & SNAPSHOT_HP) {
+            if (!reader.readI32(state.hp.hp)
+                || !reader.readI32(state.hp.hpMax)) {
+                error = "Invalid snapshot hp.";
                 return false;
             }
-            if (offset + length > size) {
+            if (!ValidateRange(state.hp.hp, 0, 100000)
+                || !ValidateRange(state.hp.hpMax, 0, 100000)) {
+                error = "Snapshot hp out of range.";
                 return false;
             }
-            value.assign(reinterpret_cast<const char*>(data + offset), length);
-            offset += length;
-            return true;
         }
-
-    private:
-        const std::uint8_t* data;
-        std::size_t size;
-        std::size_t offset;
-    };
-
-    static bool ValidateRange(int value, int minValue, int maxValue) {
-        return value >= minValue && value <= maxValue;
-    }
-
-    static bool ValidateRangeFloat(float value, float minValue, float maxValue) {
-        return IsFinite(value) && value >= minValue && value <= maxValue;
-    }
-
-    static bool ReadSanitizedText(PacketReader& reader, std::string& out, std::size_t maxLen, bool sanitizeText) {
-        if (!reader.readString(out, maxLen)) {
-            return false;
+        if (fieldMask & SNAPSHOT_PROTECTIONS) {
+            for (int i = 0; i < 8; ++i) {
+                if (!reader.readI32(state.protections.protections[i])) {
+                    error = "Invalid snapshot protections.";
+                    return false;
+                }
+                // -1 marks an immune protection slot.
+                if (!ValidateRange(state.protections.protections[i], -1, 10000)) {
+                    error = "Snapshot protection value out of range.";
+                    return false;
+                }
+            }
         }
-        if (sanitizeText) {
-            if (!SanitizeServerText(out, maxLen)) {
-                return false;
+        if (fieldMask & SNAPSHOT_TALENTS) {
+            for (int i = 0; i < 4; ++i) {
+                if (!reader.readI32(state.talents.talents[i])) {
+                    error = "Invalid snapshot talents.";
+                    return false;
+                }
+                if (!ValidateRange(state.talents.talents[i], 0, 1000)) {
+                    error = "Snapshot talent value out of range.";
+                    return false;
+                }
             }
         }
         return true;
@@ -439,16 +260,24 @@ namespace GOTHIC_ENGINE {
                 writer.writeFloat(packet.stateUpdate.pos.x);
                 writer.writeFloat(packet.stateUpdate.pos.y);
                 writer.writeFloat(packet.stateUpdate.pos.z);
+                writer.writeFloat(packet.stateUpdate.pos.vx);
+                writer.writeFloat(packet.stateUpdate.pos.vy);
+                writer.writeFloat(packet.stateUpdate.pos.vz);
                 break;
             case SYNC_HEADING:
                 writer.writeFloat(packet.stateUpdate.heading.heading);
                 break;
             case SYNC_ANIMATION:
-                writer.writeI32(packet.stateUpdate.animation.animationId);
-                if (!writer.writeString(packet.stateUpdate.animation.animationName, kMaxAnimationNameLength)) {
-                    error = "Animation name too long.";
+                if (packet.stateUpdate.animation.entries.empty() || packet.stateUpdate.animation.entries.size() > kMaxAnimationStreamEntries) {
+                    error = "Invalid animation entry count.";
                     return false;
                 }
+                writer.writeU16(packet.stateUpdate.animation.sequence);
+                writer.writeU8(static_cast<std::uint8_t>(packet.stateUpdate.animation.entries.size()));
+                for (const auto& entry : packet.stateUpdate.animation.entries) {
+                    writer.writeI32(entry.animationId);
+                    writer.writeU32(entry.startTick);
+                }
                 break;
             case SYNC_WEAPON_MODE:
                 writer.writeI32(packet.stateUpdate.weaponMode.weaponMode);
@@ -496,13 +325,13 @@ namespace GOTHIC_ENGINE {
                 writer.writeI32(packet.stateUpdate.bodyState.bodyState);
                 break;
             case SYNC_OVERLAYS:
-                if (packet.stateUpdate.overlays.overlayIds.size() > kMaxOverlayCount) {
+                if (packet.stateUpdate.overlays.overlays.size() > kMaxOverlayCount) {
                     error = "Overlay count too large.";
                     return false;
                 }
-                writer.writeU8(static_cast<std::uint8_t>(packet.stateUpdate.overlays.overlayIds.size()));
-                for (int overlayId : packet.stateUpdate.overlays.overlayIds) {
-                    writer.writeI32(overlayId);
+                writer.writeU8(static_cast<std::uint8_t>(packet.stateUpdate.overlays.overlays.size()));
+                for (auto overlay : packet.stateUpdate.overlays.overlays) {
+                    writer.writeU8(overlay);
                 }
                 break;
             case SYNC_PROTECTIONS:
@@ -571,6 +400,7 @@ namespace GOTHIC_ENGINE {
                 writer.writeFloat(packet.stateUpdate.takeItem.z);
                 break;
             case DESTROY_NPC:
+            case RELEASE_NPC:
                 break;
             case SYNC_PLAYER_NAME:
             case PLAYER_DISCONNECT:
@@ -578,6 +408,44 @@ namespace GOTHIC_ENGINE {
                 return false;
             }
             break;
+        case PacketType::StateSnapshot:
+            if (packet.snapshot.entities.size() > kMaxSnapshotEntities) {
+                error = "Snapshot entity count too large.";
+                return false;
+            }
+            writer.writeU32(packet.snapshot.sequence);
+            writer.writeU32(packet.snapshot.baselineSequence);
+            writer.writeU16(static_cast<std::uint16_t>(packet.snapshot.entities.size()));
+            for (const auto& entity : packet.snapshot.entities) {
+                if (!writer.writeString(entity.name, kMaxUniqueNameLength)) {
+                    error = "Snapshot entity name too long.";
+                    return false;
+                }
+                if (entity.fieldMask & ~kSnapshotAllFields) {
+                    error = "Invalid snapshot field mask.";
+                    return false;
+                }
+                writer.writeU16(entity.fieldMask);
+                WriteSnapshotState(writer, entity.state, entity.fieldMask);
+            }
+            break;
+        case PacketType::SnapshotAck:
+            writer.writeU32(packet.snapshotAck.sequence);
+            break;
+        case PacketType::NpcAuthority:
+            if (packet.authority.entries.empty() || packet.authority.entries.size() > kMaxAuthorityEntries) {
+                error = "Invalid authority entry count.";
+                return false;
+            }
+            writer.writeU8(static_cast<std::uint8_t>(packet.authority.entries.size()));
+            for (const auto& entry : packet.authority.entries) {
+                if (!writer.writeString(entry.npc, kMaxUniqueNameLength)
+                    || !writer.writeString(entry.owner, kMaxNameLength)) {
+                    error = "Authority name too long.";
+                    return false;
+                }
+            }
+            break;
         default:
             error = "Unknown packet type.";
             return false;
@@ -622,12 +490,14 @@ namespace GOTHIC_ENGINE {
         }
         out.senderId.clear();
         if (hasSender) {
-            if (!ReadSanitizedText(reader, out.senderId, kMaxNameLength, mode == PacketDecodeMode::Server)) {
-                error = "Invalid sender id.";
+            // Clients name the NPC a state update is about when they own it;
+            // the host checks that claim against its authority table.
+            if (mode == PacketDecodeMode::Server && out.type != PacketType::PlayerStateUpdate) {
+                error = "Sender id not allowed from client.";
                 return false;
             }
-            if (mode == PacketDecodeMode::Server) {
-                error = "Sender id not allowed from client.";
+            if (!ReadSanitizedText(reader, out.senderId, kMaxNameLength, false)) {
+                error = "Invalid sender id.";
                 return false;
             }
         }
@@ -721,13 +591,19 @@ namespace GOTHIC_ENGINE {
             case SYNC_POS:
                 if (!reader.readFloat(out.stateUpdate.pos.x)
                     || !reader.readFloat(out.stateUpdate.pos.y)
-                    || !reader.readFloat(out.stateUpdate.pos.z)) {
+                    || !reader.readFloat(out.stateUpdate.pos.z)
+                    || !reader.readFloat(out.stateUpdate.pos.vx)
+                    || !reader.readFloat(out.stateUpdate.pos.vy)
+                    || !reader.readFloat(out.stateUpdate.pos.vz)) {
                     error = "Invalid position packet.";
                     return false;
                 }
-                if (!ValidateRangeFloat(out.stateUpdate.pos.x, -100000.0f, 100000.0f)
-                    || !ValidateRangeFloat(out.stateUpdate.pos.y, -100000.0f, 100000.0f)
-                    || !ValidateRangeFloat(out.stateUpdate.pos.z, -100000.0f, 100000.0f)) {
+                if (!ValidateRangeFloat(out.stateUpdate.pos.x, -kMaxCoordinate, kMaxCoordinate)
+                    || !ValidateRangeFloat(out.stateUpdate.pos.y, -kMaxCoordinate, kMaxCoordinate)
+                    || !ValidateRangeFloat(out.stateUpdate.pos.z, -kMaxCoordinate, kMaxCoordinate)
+                    || !ValidateRangeFloat(out.stateUpdate.pos.vx, -kMaxVelocity, kMaxVelocity)
+                    || !ValidateRangeFloat(out.stateUpdate.pos.vy, -kMaxVelocity, kMaxVelocity)
+                    || !ValidateRangeFloat(out.stateUpdate.pos.vz, -kMaxVelocity, kMaxVelocity)) {
                     error = "Position out of range.";
                     return false;
                 }
@@ -743,19 +619,29 @@ namespace GOTHIC_ENGINE {
                 }
                 break;
             case SYNC_ANIMATION:
-                if (!reader.readI32(out.stateUpdate.animation.animationId)) {
+            {
+                std::uint8_t count = 0;
+                if (!reader.readU16(out.stateUpdate.animation.sequence) || !reader.readU8(count)) {
                     error = "Invalid animation packet.";
                     return false;
                 }
-                if (!ReadSanitizedText(reader, out.stateUpdate.animation.animationName, kMaxAnimationNameLength, mode == PacketDecodeMode::Server)) {
-                    error = "Invalid animation name.";
+                if (count == 0 || count > kMaxAnimationStreamEntries) {
+                    error = "Invalid animation entry count.";
                     return false;
                 }
-                if (!ValidateRange(out.stateUpdate.animation.animationId, 0, 100000)) {
-                    error = "Animation id out of range.";
-                    return false;
+                out.stateUpdate.animation.entries.resize(count);
+                for (auto& entry : out.stateUpdate.animation.entries) {
+                    if (!reader.readI32(entry.animationId) || !reader.readU32(entry.startTick)) {
+                        error = "Invalid animation packet.";
+                        return false;
+                    }
+                    if (!ValidateRange(entry.animationId, 0, 100000)) {
+                        error = "Animation id out of range.";
+                        return false;
+                    }
                 }
                 break;
+            }
             case SYNC_WEAPON_MODE:
                 if (!reader.readI32(out.stateUpdate.weaponMode.weaponMode)) {
                     error = "Invalid weapon mode packet.";
@@ -853,19 +739,16 @@ namespace GOTHIC_ENGINE {
                     error = "Overlay count too large.";
                     return false;
                 }
-                out.stateUpdate.overlays.overlayIds.clear();
-                out.stateUpdate.overlays.overlayIds.reserve(count);
-                for (std::uint8_t i = 0; i < count; ++i) {
-                    int overlayId = 0;
-                    if (!reader.readI32(overlayId)) {
+                out.stateUpdate.overlays.overlays.resize(count);
+                for (auto& overlay : out.stateUpdate.overlays.overlays) {
+                    if (!reader.readU8(overlay)) {
                         error = "Invalid overlay packet.";
                         return false;
                     }
-                    if (!ValidateRange(overlayId, 0, 200000)) {
+                    if (overlay >= kMaxOverlayCount) {
                         error = "Overlay id out of range.";
                         return false;
                     }
-                    out.stateUpdate.overlays.overlayIds.push_back(overlayId);
                 }
                 break;
             }
@@ -998,6 +881,7 @@ namespace GOTHIC_ENGINE {
                 }
                 break;
             case DESTROY_NPC:
+            case RELEASE_NPC:
                 break;
             default:
                 error = "Unknown update type.";
@@ -1005,6 +889,75 @@ namespace GOTHIC_ENGINE {
             }
             break;
         }
+        case PacketType::StateSnapshot:
+        {
+            std::uint16_t count = 0;
+            if (!reader.readU32(out.snapshot.sequence)
+                || !reader.readU32(out.snapshot.baselineSequence)
+                || !reader.readU16(count)) {
+                error = "Invalid snapshot header.";
+                return false;
+            }
+            if (out.snapshot.sequence == 0 || out.snapshot.baselineSequence >= out.snapshot.sequence) {
+                error = "Invalid snapshot sequence.";
+                return false;
+            }
+            if (count > kMaxSnapshotEntities) {
+                error = "Snapshot entity count too large.";
+                return false;
+            }
+            out.snapshot.entities.clear();
+            out.snapshot.entities.resize(count);
+            for (auto& entity : out.snapshot.entities) {
+                if (!ReadSanitizedText(reader, entity.name, kMaxUniqueNameLength, mode == PacketDecodeMode::Server)
+                    || entity.name.empty()) {
+                    error = "Invalid snapshot entity name.";
+                    return false;
+                }
+                if (!reader.readU16(entity.fieldMask)) {
+                    error = "Invalid snapshot field mask.";
+                    return false;
+                }
+                if (entity.fieldMask == 0 || (entity.fieldMask & ~kSnapshotAllFields)) {
+                    error = "Invalid snapshot field mask.";
+                    return false;
+                }
+                if (!ReadSnapshotState(reader, entity.state, entity.fieldMask, error)) {
+                    return false;
+                }
+            }
+            break;
+        }
+        case PacketType::SnapshotAck:
+            if (!reader.readU32(out.snapshotAck.sequence) || out.snapshotAck.sequence == 0) {
+                error = "Invalid snapshot ack.";
+                return false;
+            }
+            break;
+        case PacketType::NpcAuthority:
+        {
+            std::uint8_t count = 0;
+            if (!reader.readU8(count) || count == 0 || count > kMaxAuthorityEntries) {
+                error = "Invalid authority entry count.";
+                return false;
+            }
+            out.authority.entries.clear();
+            out.authority.entries.resize(count);
+            for (auto& entry : out.authority.entries) {
+                if (!ReadSanitizedText(reader, entry.npc, kMaxUniqueNameLength, mode == PacketDecodeMode::Server)
+                    || entry.npc.empty()
+                    || !ReadSanitizedText(reader, entry.owner, kMaxNameLength, mode == PacketDecodeMode::Server)) {
+                    error = "Invalid authority name.";
+                    return false;
+                }
+                // Only the host assigns owners.
+                if (mode == PacketDecodeMode::Server && !entry.owner.empty()) {
+                    error = "Authority owner not allowed from client.";
+                    return false;
+                }
+            }
+            break;
+        }
         default:
             error = "Unknown packet type.";
             return false;
@@ -1022,6 +975,17 @@ namespace GOTHIC_ENGINE {
         if (packet.type == PacketType::PlayerStateUpdate) {
             stream << ", update=" << static_cast<int>(packet.stateUpdate.updateType);
         }
+        else if (packet.type == PacketType::StateSnapshot) {
+            stream << ", seq=" << packet.snapshot.sequence
+                   << ", baseline=" << packet.snapshot.baselineSequence
+                   << ", entities=" << packet.snapshot.entities.size();
+        }
+        else if (packet.type == PacketType::SnapshotAck) {
+            stream << ", ack=" << packet.snapshotAck.sequence;
+        }
+        else if (packet.type == PacketType::NpcAuthority) {
+            stream << ", entries=" << packet.authority.entries.size();
+        }
         stream << ")";
         return stream.str();
     }
@@ -0,0 +1,461 @@
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <string_view>
+
+namespace GOTHIC_ENGINE {
+    enum UpdateType
+    {
+        SYNC_POS,
+        SYNC_HEADING,
+        SYNC_ANIMATION,
+        SYNC_WEAPON_MODE,
+        INIT_NPC,
+        DESTROY_NPC,
+        SYNC_ATTACKS,
+        SYNC_ARMOR,
+        SYNC_WEAPONS,
+        SYNC_HP,
+        SYNC_TIME,
+        SYNC_HAND,
+        SYNC_MAGIC_SETUP,
+        SYNC_SPELL_CAST,
+        SYNC_REVIVED,
+        SYNC_PROTECTIONS,
+        SYNC_PLAYER_NAME,
+        PLAYER_DISCONNECT,
+        SYNC_TALENTS,
+        SYNC_BODYSTATE,
+        SYNC_OVERLAYS,
+        SYNC_DROPITEM,
+        SYNC_TAKEITEM,
+        // The sender stops updating this NPC for the receiver, which drops its
+        // puppet and leaves the NPC itself in the world.
+        RELEASE_NPC,
+    };
+
+    enum class PacketType : std::uint8_t {
+        JoinGame = 1,
+        PlayerDisconnect = 2,
+        PlayerStateUpdate = 3,
+        StateSnapshot = 4,
+        SnapshotAck = 5,
+        NpcAuthority = 6,
+    };
+
+    struct JoinGamePacket {
+        std::uint32_t connectId = 0;
+        std::string name;
+    };
+
+    struct PlayerDisconnectPacket {
+        std::string name;
+        std::string nickname;
+        bool hasNickname = false;
+    };
+
+    struct InitNpcPayload {
+        int instanceId = 0;
+        std::string nickname;
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+        std::string bodyModel;
+        int BodyTex = 0;
+        int BodyColor = 0;
+        std::string headModel;
+        int HeadTex = 0;
+    };
+
+    // Velocity is in units per second and lets receivers extrapolate between
+    // updates; the sender only sends again when that extrapolation drifts.
+    struct SyncPosPayload {
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+        float vx = 0.0f;
+        float vy = 0.0f;
+        float vz = 0.0f;
+    };
+
+    struct SyncHeadingPayload {
+        float heading = 0.0f;
+    };
+
+    struct AnimationStreamEntry {
+        int animationId = 0;
+        // Sender clock in milliseconds when the animation started.
+        std::uint32_t startTick = 0;
+    };
+
+    // The last few animations started by the sender, oldest first. Entry i has
+    // sequence number sequence - (entries.size() - 1 - i), so a receiver can
+    // drop what it already played and recover animations from a lost datagram.
+    struct SyncAnimationPayload {
+        std::uint16_t sequence = 0;
+        std::vector<AnimationStreamEntry> entries;
+    };
+
+    struct SyncWeaponModePayload {
+        int weaponMode = 0;
+    };
+
+    struct SyncMagicSetupPayload {
+        std::string spellInstanceName;
+    };
+
+    struct SpellCastInfo {
+        std::string target;
+        int spellInstanceId = 0;
+        int spellLevel = 0;
+        int spellCharge = 0;
+    };
+
+    struct SyncSpellCastPayload {
+        std::vector<SpellCastInfo> casts;
+    };
+
+    struct SyncArmorPayload {
+        std::string armor;
+    };
+
+    struct SyncWeaponsPayload {
+        std::string weapon1;
+        std::string weapon2;
+    };
+
+    struct SyncHpPayload {
+        int hp = 0;
+        int hpMax = 0;
+    };
+
+    struct SyncBodyStatePayload {
+        int bodyState = 0;
+    };
+
+    // Indices into the known overlay MDS table, in the order the overlays are
+    // stacked on the model. Later overlays override earlier ones.
+    struct SyncOverlaysPayload {
+        std::vector<std::uint8_t> overlays;
+    };
+
+    struct SyncProtectionsPayload {
+        int protections[8] = {0};
+    };
+
+    struct SyncTalentsPayload {
+        int talents[4] = {0};
+    };
+
+    struct SyncHandPayload {
+        std::string leftItem;
+        std::string rightItem;
+    };
+
+    struct SyncTimePayload {
+        float rawTime = 0.0f;
+    };
+
+    struct SyncRevivedPayload {
+        std::string name;
+    };
+
+    struct AttackInfo {
+        std::string target;
+        float damage = 0.0f;
+        int isUnconscious = 0;
+        bool isDead = false;
+        bool isFinish = false;
+        unsigned long damageMode = 0;
+    };
+
+    struct SyncAttacksPayload {
+        std::vector<AttackInfo> attacks;
+    };
+
+    struct SyncDropItemPayload {
+        std::string itemDropped;
+        int count = 0;
+        int flags = 0;
+        std::string itemUniqueName;
+    };
+
+    struct SyncTakeItemPayload {
+        std::string itemDropped;
+        int count = 0;
+        int flags = 0;
+        std::string uniqueName;
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+    };
+
+    struct PlayerStateUpdatePacket {
+        UpdateType updateType = SYNC_POS;
+        InitNpcPayload initNpc;
+        SyncPosPayload pos;
+        SyncHeadingPayload heading;
+        SyncAnimationPayload animation;
+        SyncWeaponModePayload weaponMode;
+        SyncMagicSetupPayload magicSetup;
+        SyncSpellCastPayload spellCasts;
+        SyncArmorPayload armor;
+        SyncWeaponsPayload weapons;
+        SyncHpPayload hp;
+        SyncBodyStatePayload bodyState;
+        SyncOverlaysPayload overlays;
+        SyncProtectionsPayload protections;
+        SyncTalentsPayload talents;
+        SyncHandPayload hand;
+        SyncTimePayload time;
+        SyncRevivedPayload revived;
+        SyncAttacksPayload attacks;
+        SyncDropItemPayload dropItem;
+        SyncTakeItemPayload takeItem;
+    };
+
+    enum SnapshotField : std::uint16_t {
+        SNAPSHOT_POS = 1 << 0,
+        SNAPSHOT_HEADING = 1 << 1,
+        SNAPSHOT_WEAPON_MODE = 1 << 2,
+        SNAPSHOT_HP = 1 << 3,
+        SNAPSHOT_PROTECTIONS = 1 << 4,
+        SNAPSHOT_TALENTS = 1 << 5,
+    };
+
+    constexpr std::uint16_t kSnapshotAllFields = SNAPSHOT_POS | SNAPSHOT_HEADING | SNAPSHOT_WEAPON_MODE
+        | SNAPSHOT_HP | SNAPSHOT_PROTECTIONS | SNAPSHOT_TALENTS;
+    // Protections and talents are only tracked for players, other NPCs never carry them.
+    constexpr std::uint16_t kSnapshotNpcFields = SNAPSHOT_POS | SNAPSHOT_HEADING | SNAPSHOT_WEAPON_MODE | SNAPSHOT_HP;
+
+    struct EntitySnapshotState {
+        SyncPosPayload pos;
+        SyncHeadingPayload heading;
+        SyncWeaponModePayload weaponMode;
+        SyncHpPayload hp;
+        SyncProtectionsPayload protections;
+        SyncTalentsPayload talents;
+    };
+
+    // Only the fields set in fieldMask are carried on the wire; the rest are
+    // taken from the baseline the snapshot was encoded against.
+    struct EntitySnapshot {
+        std::string name;
+        std::uint16_t fieldMask = 0;
+        EntitySnapshotState state;
+    };
+
+    struct StateSnapshotPacket {
+        std::uint32_t sequence = 0;
+        std::uint32_t baselineSequence = 0; // 0 = full snapshot
+        std::vector<EntitySnapshot> entities;
+    };
+
+    struct SnapshotAckPacket {
+        std::uint32_t sequence = 0;
+    };
+
+    // Clients send entries as claims for NPCs they are closest to, with owner
+    // left empty. The host answers with the resulting owner of each NPC, empty
+    // meaning the host itself.
+    struct NpcAuthorityEntry {
+        std::string npc;
+        std::string owner;
+    };
+
+    struct NpcAuthorityPacket {
+        std::vector<NpcAuthorityEntry> entries;
+    };
+
+    struct NetworkPacket {
+        PacketType type = PacketType::PlayerStateUpdate;
+        std::string senderId;
+        JoinGamePacket joinGame;
+        PlayerDisconnectPacket disconnect;
+        PlayerStateUpdatePacket stateUpdate;
+        StateSnapshotPacket snapshot;
+        SnapshotAckPacket snapshotAck;
+        NpcAuthorityPacket authority;
+        // Not serialized. Bit n selects the peer with friendIdNumber n, 0 sends to everyone.
+        std::uint64_t recipientMask = 0;
+    };
+
+    enum class PacketDecodeMode {
+        Client,
+        Server,
+    };
+
+    constexpr std::uint8_t kNetworkPacketVersion = 11;
+    constexpr std::size_t kMaxPacketBytes = 16384;
+    constexpr std::size_t kMaxNameLength = 64;
+    constexpr std::size_t kMaxNicknameLength = 32;
+    constexpr std::size_t kMaxInstanceNameLength = 64;
+    constexpr std::size_t kMaxUniqueNameLength = 96;
+    constexpr std::size_t kMaxOverlayCount = 64;
+    constexpr std::size_t kMaxSpellCastCount = 32;
+    constexpr std::size_t kMaxAttackCount = 32;
+    constexpr std::size_t kMaxAnimationStreamEntries = 8;
+    constexpr std::size_t kMaxSnapshotEntities = 256;
+    constexpr std::size_t kMaxAuthorityEntries = 64;
+    constexpr float kMaxCoordinate = 100000.0f;
+    constexpr float kMaxVelocity = 5000.0f;
+    constexpr int kMinSkinColor = 0;
+    constexpr int kMaxSkinColor = 3;
+
+    class PacketWriter {
+    public:
+        bool writeU8(std::uint8_t value) {
+            buffer.push_back(value);
+            return true;
+        }
+
+        bool writeU16(std::uint16_t value) {
+            buffer.push_back(static_cast<std::uint8_t>(value & 0xFF));
+            buffer.push_back(static_cast<std::uint8_t>((value >> 8) & 0xFF));
+            return true;
+        }
+
+        bool writeU32(std::uint32_t value) {
+            for (int i = 0; i < 4; ++i) {
+                buffer.push_back(static_cast<std::uint8_t>((value >> (8 * i)) & 0xFF));
+            }
+            return true;
+        }
+
+        bool writeI32(std::int32_t value) {
+            return writeU32(static_cast<std::uint32_t>(value));
+        }
+
+        bool writeBool(bool value) {
+            return writeU8(value ? 1 : 0);
+        }
+
+        bool writeFloat(float value) {
+            static_assert(sizeof(float) == sizeof(std::uint32_t), "Unexpected float size.");
+            std::uint32_t raw;
+            std::memcpy(&raw, &value, sizeof(raw));
+            return writeU32(raw);
+        }
+
+        bool writeString(const std::string& value, std::size_t maxLen) {
+            if (value.size() > maxLen) {
+                return false;
+            }
+            if (!writeU16(static_cast<std::uint16_t>(value.size()))) {
+                return false;
+            }
+            buffer.insert(buffer.end(), value.begin(), value.end());
+            return true;
+        }
+
+        const std::vector<std::uint8_t>& data() const { return buffer; }
+
+    private:
+        std::vector<std::uint8_t> buffer;
+    };
+
+    class PacketReader {
+    public:
+        PacketReader(const std::uint8_t* data, std::size_t size)
+            : data(data)
+            , size(size)
+            , offset(0) {}
+
+        bool readU8(std::uint8_t& value) {
+            if (offset + 1 > size) {
+                return false;
+            }
+            value = data[offset];
+            offset += 1;
+            return true;
+        }
+
+        bool readU16(std::uint16_t& value) {
+            if (offset + 2 > size) {
+                return false;
+            }
+            value = static_cast<std::uint16_t>(data[offset])
+                | (static_cast<std::uint16_t>(data[offset + 1]) << 8);
+            offset += 2;
+            return true;
+        }
+
+        bool readU32(std::uint32_t& value) {
+            if (offset + 4 > size) {
+                return false;
+            }
+            value = static_cast<std::uint32_t>(data[offset])
+                | (static_cast<std::uint32_t>(data[offset + 1]) << 8)
+                | (static_cast<std::uint32_t>(data[offset + 2]) << 16)
+                | (static_cast<std::uint32_t>(data[offset + 3]) << 24);
+            offset += 4;
+            return true;
+        }
+
+        bool readI32(std::int32_t& value) {
+            std::uint32_t raw = 0;
+            if (!readU32(raw)) {
+                return false;
+            }
+            value = static_cast<std::int32_t>(raw);
+            return true;
+        }
+
+        bool readBool(bool& value) {
+            std::uint8_t raw = 0;
+            if (!readU8(raw)) {
+                return false;
+            }
+            value = raw != 0;
+            return true;
+        }
+
+        bool readFloat(float& value) {
+            std::uint32_t raw = 0;
+            if (!readU32(raw)) {
+                return false;
+            }
+            std::memcpy(&value, &raw, sizeof(raw));
+            return true;
+        }
+
+        bool readString(std::string& value, std::size_t maxLen) {
+            std::string_view view;
+            if (!readStringView(view, maxLen)) {
+                return false;
+            }
+            value.assign(view.data(), view.size());
+            return true;
+        }
+
+        // The view points into the packet buffer and is only valid while it is alive.
+        bool readStringView(std::string_view& value, std::size_t maxLen) {
+            std::uint16_t length = 0;
+            if (!readU16(length)) {
+                return false;
+            }
+            if (length > maxLen) {
+                return false;
+            }
+            if (offset + length > size) {
+                return false;
+            }
+            value = std::string_view(reinterpret_cast<const char*>(data + offset), length);
+            offset += length;
+            return true;
+        }
+
+    private:
+        const std::uint8_t* data;
+        std::size_t size;
+        std::size_t offset;
+    };
+
+    bool IsPrintableServerText(std::string_view text);
+    bool SanitizeServerText(std::string& text, std::size_t maxLen);
+    std::size_t SnapshotEntityWireSize(const EntitySnapshot& entity);
+    bool SerializeNetworkPacket(const NetworkPacket& packet, std::vector<std::uint8_t>& out, std::string& error);
+    bool DeserializeNetworkPacket(const std::uint8_t* data, std::size_t size, NetworkPacket& out, std::string& error, PacketDecodeMode mode);
+    std::string DescribePacket(const NetworkPacket& packet);
+}
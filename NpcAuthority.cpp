@@ -0,0 +1,281 @@
+#include <cfloat>
+#include <vector>
+
+namespace GOTHIC_ENGINE {
+    // Which peer simulates and broadcasts each NPC. With DistributedAuthority,
+    // clients claim the NPCs they are the closest player to and the host,
+    // which keeps the table, grants or ignores each claim and tells every
+    // client the result. NPCs missing from the table belong to the host.
+    static std::map<string, string> NpcAuthorityOwners;
+    // Client only: when each NPC was last claimed, so claims are not repeated every frame.
+    static std::map<string, long long> NpcAuthorityClaimTimes;
+    // Host only: ownership changes not yet sent to the clients.
+    static std::vector<NpcAuthorityEntry> PendingAuthorityChanges;
+
+    string GetNpcAuthority(const string& npcName) {
+        auto it = NpcAuthorityOwners.find(npcName);
+        return it != NpcAuthorityOwners.end() ? it->second : string("HOST");
+    }
+
+    bool IsNpcAuthorityLocal(const string& npcName) {
+        return GetNpcAuthority(npcName) == MyselfId;
+    }
+
+    // NPCs whose AI this peer runs for everybody. Other NPCs are puppets of
+    // their owner, and their hits arrive from the owner as SYNC_ATTACKS.
+    bool IsNpcSimulatedLocally(oCNpc* npc) {
+        if (!npc || npc == player || PlayerNpcs.count(npc)) {
+            return false;
+        }
+
+        auto it = NpcToUniqueNameList.find(npc);
+        if (it == NpcToUniqueNameList.end()) {
+            return ServerThread != NULL;
+        }
+        return IsNpcAuthorityLocal(it->second);
+    }
+
+    // World NPCs another peer simulates. Their AI, animations and hits come
+    // from the owner's updates, on the host as much as on clients.
+    bool IsNpcPuppet(oCNpc* npc) {
+        if (!npc || npc == player || PlayerNpcs.count(npc) || IsCoopPaused) {
+            return false;
+        }
+        return (ServerThread || ClientThread) && !IsNpcSimulatedLocally(npc);
+    }
+
+    static bool GetCoopPlayerPosition(const string& playerName, zVEC3& position) {
+        if (playerName == MyselfId) {
+            if (!player) {
+                return false;
+            }
+            position = player->GetPositionWorld();
+            return true;
+        }
+
+        auto it = SyncNpcs.find(playerName);
+        if (it == SyncNpcs.end() || !it->second->lastPositionFromServer) {
+            return false;
+        }
+        position = *it->second->lastPositionFromServer;
+        return true;
+    }
+
+    static float GetCoopPlayerDistance(const string& playerName, const zVEC3& position) {
+        zVEC3 playerPosition;
+        if (!GetCoopPlayerPosition(playerName, playerPosition)) {
+            return FLT_MAX;
+        }
+        return GetVec3LengthApprox(playerPosition - position);
+    }
+
+    // The previous owner's puppet or broadcaster is dropped without touching
+    // the NPC itself, which stays in the world for the new role.
+    static void SetNpcAuthority(const string& npcName, const string& owner) {
+        auto previous = GetNpcAuthority(npcName);
+        if (previous == owner) {
+            return;
+        }
+
+        if (owner == "HOST") {
+            NpcAuthorityOwners.erase(npcName);
+        }
+        else {
+            NpcAuthorityOwners[npcName] = owner;
+        }
+
+        if (previous == MyselfId) {
+            auto broadcastIt = BroadcastNpcs.find(npcName);
+            if (broadcastIt != BroadcastNpcs.end()) {
+                delete broadcastIt->second;
+                BroadcastNpcs.erase(broadcastIt);
+            }
+
+            // Stop what the local AI was doing, the new owner drives the NPC from now on.
+            auto npcIt = UniqueNameToNpcList.find(npcName);
+            if (npcIt != UniqueNameToNpcList.end() && npcIt->second) {
+                auto npc = npcIt->second;
+                npc->GetEM()->KillMessages();
+                npc->ClearEM();
+                npc->state.ClearAIState();
+            }
+        }
+        if (owner == MyselfId) {
+            auto syncIt = SyncNpcs.find(npcName);
+            if (syncIt != SyncNpcs.end()) {
+                syncIt->second->destroyed = true;
+            }
+        }
+
+        if (ServerThread) {
+            NpcAuthorityEntry entry;
+            entry.npc = npcName.ToChar();
+            entry.owner = owner == "HOST" ? std::string() : std::string(owner.ToChar());
+            PendingAuthorityChanges.push_back(entry);
+        }
+    }
+
+    static void SendAuthorityEntries(const std::vector<NpcAuthorityEntry>& entries, std::uint64_t recipientMask) {
+        for (std::size_t start = 0; start < entries.size(); start += kMaxAuthorityEntries) {
+            NetworkPacket packet;
+            packet.type = PacketType::NpcAuthority;
+            packet.senderId = ServerThread ? std::string("HOST") : std::string();
+            packet.recipientMask = recipientMask;
+            auto end = start + kMaxAuthorityEntries < entries.size() ? start + kMaxAuthorityEntries : entries.size();
+            packet.authority.entries.assign(entries.begin() + start, entries.begin() + end);
+            ReadyToSendPackets.enqueue(packet);
+        }
+    }
+
+    static void FlushNpcAuthorityChanges() {
+        if (ServerThread && !PendingAuthorityChanges.empty()) {
+            SendAuthorityEntries(PendingAuthorityChanges, 0);
+        }
+        PendingAuthorityChanges.clear();
+    }
+
+    // Host: a client asks for NPCs it is closest to. The claim is granted when
+    // the client is within broadcast range and clearly closer than the owner.
+    // Distances are measured from where the host has the NPC, never from a
+    // position the client reports, and NPCs the host does not know are ignored.
+    void ProcessNpcAuthorityClaims(const string& claimant, const NetworkPacket& packet) {
+        if (!DistributedAuthority) {
+            return;
+        }
+
+        for (const auto& entry : packet.authority.entries) {
+            string npcName = entry.npc.c_str();
+            auto owner = GetNpcAuthority(npcName);
+            if (owner == claimant) {
+                continue;
+            }
+
+            auto npcIt = UniqueNameToNpcList.find(npcName);
+            if (npcIt == UniqueNameToNpcList.end() || !npcIt->second) {
+                continue;
+            }
+
+            auto npcPosition = npcIt->second->GetPositionWorld();
+            float claimantDistance = GetCoopPlayerDistance(claimant, npcPosition);
+            if (claimantDistance > BROADCAST_DISTANCE) {
+                continue;
+            }
+            if (GetCoopPlayerDistance(owner, npcPosition) <= claimantDistance + NPC_AUTHORITY_HANDOFF_MARGIN) {
+                continue;
+            }
+
+            SetNpcAuthority(npcName, claimant);
+        }
+        FlushNpcAuthorityChanges();
+    }
+
+    // Client: the host announced new owners.
+    void ProcessNpcAuthorityChanges(const NetworkPacket& packet) {
+        for (const auto& entry : packet.authority.entries) {
+            string npcName = entry.npc.c_str();
+            SetNpcAuthority(npcName, entry.owner.empty() ? string("HOST") : string(entry.owner.c_str()));
+            NpcAuthorityClaimTimes.erase(npcName);
+        }
+    }
+
+    // Host: a client left, its NPCs return to the host.
+    void ReleaseNpcAuthority(const string& owner) {
+        std::vector<string> released;
+        for (auto& entry : NpcAuthorityOwners) {
+            if (entry.second == owner) {
+                released.push_back(entry.first);
+            }
+        }
+        for (auto& npcName : released) {
+            SetNpcAuthority(npcName, "HOST");
+        }
+        FlushNpcAuthorityChanges();
+    }
+
+    // Host: a client joined and needs to know who owns what.
+    void SendNpcAuthorityTable(std::uint64_t recipientMask) {
+        std::vector<NpcAuthorityEntry> entries;
+        for (auto& owner : NpcAuthorityOwners) {
+            NpcAuthorityEntry entry;
+            entry.npc = owner.first.ToChar();
+            entry.owner = owner.second.ToChar();
+            entries.push_back(entry);
+        }
+        if (!entries.empty()) {
+            SendAuthorityEntries(entries, recipientMask);
+        }
+    }
+
+    void ClearNpcAuthority() {
+        if (ServerThread) {
+            for (auto& owner : NpcAuthorityOwners) {
+                NpcAuthorityEntry entry;
+                entry.npc = owner.first.ToChar();
+                PendingAuthorityChanges.push_back(entry);
+            }
+        }
+        FlushNpcAuthorityChanges();
+        NpcAuthorityOwners.clear();
+        NpcAuthorityClaimTimes.clear();
+    }
+
+    // Decides which of the NPCs near the local player this peer simulates.
+    // The host keeps everything nobody else took and takes NPCs back once it
+    // is clearly closer than their owner; clients claim NPCs they are the
+    // closest player to. Returns the NPCs this peer should broadcast.
+    std::vector<oCNpc*> UpdateNpcAuthority(const std::vector<oCNpc*>& visibleNpcs) {
+        std::vector<oCNpc*> owned;
+        std::vector<NpcAuthorityEntry> claims;
+
+        for (auto npc : visibleNpcs) {
+            auto nameIt = NpcToUniqueNameList.find(npc);
+            if (nameIt == NpcToUniqueNameList.end()) {
+                continue;
+            }
+            auto npcName = nameIt->second;
+            auto owner = GetNpcAuthority(npcName);
+            if (owner == MyselfId) {
+                owned.push_back(npc);
+                continue;
+            }
+            if (!DistributedAuthority) {
+                continue;
+            }
+
+            auto npcPosition = npc->GetPositionWorld();
+            float ownDistance = GetVec3LengthApprox(player->GetPositionWorld() - npcPosition);
+            if (ownDistance + NPC_AUTHORITY_HANDOFF_MARGIN >= GetCoopPlayerDistance(owner, npcPosition)) {
+                continue;
+            }
+
+            if (ServerThread) {
+                SetNpcAuthority(npcName, MyselfId);
+                owned.push_back(npc);
+                continue;
+            }
+
+            bool closest = true;
+            for (auto& playerNpc : PlayerNpcs) {
+                if (playerNpc.second != owner && GetCoopPlayerDistance(playerNpc.second, npcPosition) < ownDistance) {
+                    closest = false;
+                    break;
+                }
+            }
+            auto claimIt = NpcAuthorityClaimTimes.find(npcName);
+            if (!closest || (claimIt != NpcAuthorityClaimTimes.end() && CurrentMs < claimIt->second + NPC_AUTHORITY_CLAIM_RETRY_MS)) {
+                continue;
+            }
+
+            NpcAuthorityClaimTimes[npcName] = CurrentMs;
+            NpcAuthorityEntry claim;
+            claim.npc = npcName.ToChar();
+            claims.push_back(claim);
+        }
+
+        if (!claims.empty()) {
+            SendAuthorityEntries(claims, 0);
+        }
+        FlushNpcAuthorityChanges();
+        return owned;
+    }
+}
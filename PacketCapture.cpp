@@ -0,0 +1,234 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+namespace GOTHIC_ENGINE {
+    // Capture file layout, little endian, every record starts 8-byte aligned so
+    // the file can be memory-mapped and walked in place:
+    //   header:  char magic[4] "GCAP", u16 formatVersion, u8 packetVersion, u8 role,
+    //            u64 startUnixUs
+    //   record:  u64 timestampUs (since start), u8 direction, u8 channel, u16 peer,
+    //            u32 length, payload[length], zero padding to 8 bytes
+    constexpr char kCaptureMagic[4] = { 'G', 'C', 'A', 'P' };
+    constexpr std::uint16_t kCaptureFormatVersion = 1;
+    constexpr std::uint16_t kCaptureBroadcastPeer = 0xFFFF;
+    // Buffered records reach the disk at least this often, so a crash loses
+    // no more than the last interval.
+    constexpr std::chrono::milliseconds kCaptureFlushInterval(1000);
+
+    enum class CaptureDirection : std::uint8_t {
+        Inbound = 0,
+        Outbound = 1,
+    };
+
+    enum class CaptureRole : std::uint8_t {
+        Client = 0,
+        Host = 1,
+    };
+
+#pragma pack(push, 1)
+    struct CaptureFileHeader {
+        char magic[4];
+        std::uint16_t formatVersion;
+        std::uint8_t packetVersion;
+        std::uint8_t role;
+        std::uint64_t startUnixUs;
+    };
+
+    struct CaptureRecordHeader {
+        std::uint64_t timestampUs;
+        std::uint8_t direction;
+        std::uint8_t channel;
+        std::uint16_t peer;
+        std::uint32_t length;
+    };
+#pragma pack(pop)
+
+    static_assert(sizeof(CaptureFileHeader) == 16, "Unexpected capture header size.");
+    static_assert(sizeof(CaptureRecordHeader) == 16, "Unexpected capture record size.");
+
+    static std::size_t CapturePaddedLength(std::size_t length) {
+        return (length + 7) & ~static_cast<std::size_t>(7);
+    }
+
+    // Written from the network threads; the mutex only matters while a host
+    // thread and a previous client thread overlap during shutdown.
+    class PacketCaptureWriter {
+    public:
+        ~PacketCaptureWriter() {
+            Close();
+        }
+
+        bool Open(const std::string& path, CaptureRole role) {
+            std::lock_guard<std::mutex> lock(mutex);
+            CloseLocked();
+
+            file = std::fopen(path.c_str(), "wb");
+            if (!file) {
+                return false;
+            }
+
+            CaptureFileHeader header;
+            std::memcpy(header.magic, kCaptureMagic, sizeof(header.magic));
+            header.formatVersion = kCaptureFormatVersion;
+            header.packetVersion = kNetworkPacketVersion;
+            header.role = static_cast<std::uint8_t>(role);
+            header.startUnixUs = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+            start = std::chrono::steady_clock::now();
+            lastFlush = start;
+            openRole = role;
+
+            if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+                CloseLocked();
+                return false;
+            }
+            return true;
+        }
+
+        void Write(CaptureDirection direction, std::uint8_t channel, std::uint16_t peer, const std::uint8_t* data, std::size_t length) {
+            static const std::uint8_t padding[8] = { 0 };
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!file || length > 0xFFFFFFFFu) {
+                return;
+            }
+
+            CaptureRecordHeader record;
+            record.timestampUs = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count());
+            record.direction = static_cast<std::uint8_t>(direction);
+            record.channel = channel;
+            record.peer = peer;
+            record.length = static_cast<std::uint32_t>(length);
+
+            std::fwrite(&record, sizeof(record), 1, file);
+            if (length > 0) {
+                std::fwrite(data, 1, length, file);
+            }
+            std::fwrite(padding, 1, CapturePaddedLength(length) - length, file);
+        }
+
+        // Called from the network thread loops.
+        void FlushIfDue() {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!file) {
+                return;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastFlush >= kCaptureFlushInterval) {
+                std::fflush(file);
+                lastFlush = now;
+            }
+        }
+
+        // Closes the capture only when it was opened for role, so a stopping
+        // thread leaves a capture another thread opened alone.
+        bool Close(CaptureRole role) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!file || openRole != role) {
+                return false;
+            }
+            CloseLocked();
+            return true;
+        }
+
+        void Close() {
+            std::lock_guard<std::mutex> lock(mutex);
+            CloseLocked();
+        }
+
+    private:
+        void CloseLocked() {
+            if (file) {
+                std::fclose(file);
+                file = nullptr;
+            }
+        }
+
+        std::mutex mutex;
+        std::FILE* file = nullptr;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point lastFlush;
+        CaptureRole openRole = CaptureRole::Client;
+    };
+
+    struct CaptureRecordView {
+        std::uint64_t timestampUs = 0;
+        CaptureDirection direction = CaptureDirection::Inbound;
+        std::uint8_t channel = 0;
+        std::uint16_t peer = 0;
+        const std::uint8_t* data = nullptr;
+        std::uint32_t length = 0;
+    };
+
+    // Walks a capture already in memory (typically memory-mapped) without copying.
+    class PacketCaptureReader {
+    public:
+        PacketCaptureReader(const std::uint8_t* data, std::size_t size)
+            : data(data)
+            , size(size)
+            , offset(sizeof(CaptureFileHeader)) {}
+
+        bool ReadHeader(CaptureFileHeader& header, std::string& error) const {
+            if (!data || size < sizeof(CaptureFileHeader)) {
+                error = "Capture too small.";
+                return false;
+            }
+            std::memcpy(&header, data, sizeof(header));
+            if (std::memcmp(header.magic, kCaptureMagic, sizeof(header.magic)) != 0) {
+                error = "Not a packet capture.";
+                return false;
+            }
+            if (header.formatVersion != kCaptureFormatVersion) {
+                error = "Unsupported capture format version.";
+                return false;
+            }
+            return true;
+        }
+
+        // Returns false at the end of the capture or on a truncated record.
+        bool Next(CaptureRecordView& record) {
+            if (offset + sizeof(CaptureRecordHeader) > size) {
+                return false;
+            }
+
+            CaptureRecordHeader header;
+            std::memcpy(&header, data + offset, sizeof(header));
+            std::size_t payloadOffset = offset + sizeof(header);
+            if (header.length > size - payloadOffset) {
+                truncated = true;
+                return false;
+            }
+
+            record.timestampUs = header.timestampUs;
+            record.direction = static_cast<CaptureDirection>(header.direction);
+            record.channel = header.channel;
+            record.peer = header.peer;
+            record.data = data + payloadOffset;
+            record.length = header.length;
+
+            offset = payloadOffset + CapturePaddedLength(header.length);
+            return true;
+        }
+
+        void Rewind() {
+            offset = sizeof(CaptureFileHeader);
+            truncated = false;
+        }
+
+        bool Truncated() const {
+            return truncated;
+        }
+
+    private:
+        const std::uint8_t* data;
+        std::size_t size;
+        std::size_t offset;
+        bool truncated = false;
+    };
+}
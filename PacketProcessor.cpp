@@ -3,6 +3,8 @@ namespace GOTHIC_ENGINE {
         if (packetData.type == PacketType::JoinGame) {
             if (packetData.joinGame.connectId == packet.peer->connectID) {
                 MyselfId = packetData.joinGame.name.c_str();
+                // A restarted host counts its snapshots from 0 again.
+                ResetSnapshotPeer("HOST");
             }
             return;
         }
@@ -17,6 +19,13 @@ namespace GOTHIC_ENGINE {
             return;
         }
 
+        if (packetData.type == PacketType::NpcAuthority) {
+            if (ClientThread) {
+                ProcessNpcAuthorityChanges(packetData);
+            }
+            return;
+        }
+
         if (packetData.type != PacketType::PlayerStateUpdate) {
             ChatLog("Invalid packet received (unknown type).");
             return;
@@ -29,6 +38,10 @@ namespace GOTHIC_ENGINE {
 
         auto id = packetData.senderId;
         auto type = packetData.stateUpdate.updateType;
+        // Late updates from the previous owner of an NPC this peer took over.
+        if (!IsCoopPlayer(id) && IsNpcAuthorityLocal(id.c_str())) {
+            return;
+        }
         RemoteNpc* npcToSync = NULL;
         auto syncIt = SyncNpcs.find(id.c_str());
         if (syncIt != SyncNpcs.end()) {
@@ -57,6 +70,10 @@ namespace GOTHIC_ENGINE {
             //ChatLog(e.dump().c_str());
         }
 
+        if (npcToSync == NULL && type == RELEASE_NPC) {
+            return;
+        }
+
         if (npcToSync == NULL) {
             if (IsCoopPlayer(id)) {
                 npcToSync = addSyncedNpc(id.c_str());
@@ -70,7 +87,7 @@ namespace GOTHIC_ENGINE {
         }
 
         if (npcToSync) {
-            npcToSync->localUpdates.push_back(packetData.stateUpdate);
+            npcToSync->localUpdates.Push(packetData.stateUpdate);
         }
     }
 
@@ -89,6 +106,9 @@ namespace GOTHIC_ENGINE {
             ReadyToSendPackets.enqueue(joinPacket);
 
             addSyncedNpc(playerName);
+            ResetSnapshotPeer(playerName);
+            SendNpcAuthorityTable(1ull << friendIdNumber);
+            ResetInterestPeer(friendIdNumber);
 
             auto d = new PeerData();
             d->friendId = playerName;
@@ -121,14 +141,47 @@ namespace GOTHIC_ENGINE {
                 enet_packet_destroy(packet.packet);
                 break;
             }
+            if (incoming.type == PacketType::StateSnapshot || incoming.type == PacketType::SnapshotAck) {
+                incoming.senderId = player->friendId.ToChar();
+                if (incoming.type == PacketType::StateSnapshot) {
+                    ProcessSnapshotPacket(incoming, packet);
+                }
+                else {
+                    ProcessSnapshotAck(incoming);
+                }
+                enet_packet_destroy(packet.packet);
+                break;
+            }
+            if (incoming.type == PacketType::NpcAuthority) {
+                ProcessNpcAuthorityClaims(player->friendId, incoming);
+                enet_packet_destroy(packet.packet);
+                break;
+            }
             if (incoming.type != PacketType::PlayerStateUpdate) {
                 ChatLog("Invalid packet received (unexpected type).");
                 enet_packet_destroy(packet.packet);
                 break;
             }
-            incoming.senderId = player->friendId.ToChar();
+            // Clients send their own player unnamed and the NPCs they own by name.
+            if (incoming.senderId.empty()) {
+                incoming.senderId = player->friendId.ToChar();
+            }
+            else if (GetNpcAuthority(incoming.senderId.c_str()) != player->friendId) {
+                enet_packet_destroy(packet.packet);
+                break;
+            }
+            // Relayed to everybody else, and NPCs only to the peers interested in them.
+            incoming.recipientMask = ~0ull;
+            if (player->friendIdNumber >= 0 && player->friendIdNumber < 64) {
+                incoming.recipientMask &= ~(1ull << player->friendIdNumber);
+            }
+            if (!IsCoopPlayer(incoming.senderId)) {
+                incoming.recipientMask &= GetInterestMask(incoming.senderId.c_str());
+            }
 
-            ReadyToBeDistributedPackets.enqueue(incoming);
+            if (incoming.recipientMask != 0) {
+                ReadyToBeDistributedPackets.enqueue(incoming);
+            }
             ProcessCoopPacket(incoming, packet);
 #if defined(COOP_ENABLE_JSON_DEBUG) && COOP_ENABLE_JSON_DEBUG
             SaveNetworkPacket(DescribePacket(incoming).c_str());
@@ -154,6 +207,9 @@ namespace GOTHIC_ENGINE {
 
             if (remoteNpc) {
                 removeSyncedNpc(remoteNpc->friendId);
+                ResetSnapshotPeer(remoteNpc->friendId);
+                ReleaseNpcAuthority(remoteNpc->friendId);
+                ResetInterestPeer(remoteNpc->friendIdNumber);
                 ReleasePlayerId(remoteNpc->friendIdNumber);
                 delete remoteNpc;
             }
@@ -176,7 +232,15 @@ namespace GOTHIC_ENGINE {
                 enet_packet_destroy(packet.packet);
                 break;
             }
-            ProcessCoopPacket(incoming, packet);
+            if (incoming.type == PacketType::StateSnapshot) {
+                ProcessSnapshotPacket(incoming, packet);
+            }
+            else if (incoming.type == PacketType::SnapshotAck) {
+                ProcessSnapshotAck(incoming);
+            }
+            else {
+                ProcessCoopPacket(incoming, packet);
+            }
 #if defined(COOP_ENABLE_JSON_DEBUG) && COOP_ENABLE_JSON_DEBUG
             SaveNetworkPacket(DescribePacket(incoming).c_str());
 #endif
@@ -188,6 +252,7 @@ namespace GOTHIC_ENGINE {
         case ENET_EVENT_TYPE_DISCONNECT:
         {
             ChatLog("Connection to the server lost.");
+            ClearSnapshotPeers();
             break;
         }
         }
@@ -1,3 +1,7 @@
+#include <cctype>
+#include <cstdint>
+#include <unordered_map>
+
 int DANGERGetCurrentAni(GOTHIC_ENGINE::zCModel* model, int index) {
     __try
     {
@@ -79,31 +83,129 @@ namespace GOTHIC_ENGINE {
         {"T_MAGSNEAKTURNR"}
     };
 
-    bool IsAniBlockedForAll(zCModelAni* modelAni)
-    {
-        if (modelAni)
-        {
-            auto aniName = modelAni->GetAniName();
-            for (unsigned int i = 0; i < 8; i++)
-            {
-                if (aniName && strcmp(aniName.ToChar(), BlockedAnimationsForAll[i]) == 0)
-                    return true;
+    enum AnimationClassFlag : std::uint8_t {
+        ANIMATION_BLOCKED = 1 << 0,
+        ANIMATION_TURNING = 1 << 1,
+        ANIMATION_INTERACTION = 1 << 2,
+    };
+
+    struct AnimationClass {
+        std::uint8_t flags = 0;
+        int mobState = 1;
+    };
+
+    // Looked up every frame for every history entry, so keyed by the animation
+    // itself. Prototypes are released around level loads, which clear it; the
+    // stored aniID catches an address reused by another animation in between.
+    struct CachedAnimationClass {
+        int aniID;
+        AnimationClass animationClass;
+    };
+    static std::unordered_map<zCModelAni*, CachedAnimationClass> AnimationClassCache;
+    // The class depends only on the name, so an animation seen before under
+    // another address is not classified again. Never cleared.
+    static std::unordered_map<std::string, AnimationClass> AnimationClassByName;
+
+    static std::string ToUpper(std::string value) {
+        for (char& c : value) {
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        return value;
+    }
+
+    static bool IsInteractionAnimationName(const std::string& upperName) {
+        return upperName.find("DOOR") != std::string::npos
+            || upperName.find("LEVER") != std::string::npos
+            || upperName.find("TOUCHPLATE") != std::string::npos
+            || upperName.find("VWHEEL") != std::string::npos;
+    }
+
+    static int ExtractMobStateFromAnimationName(const std::string& upperName, int fallbackState) {
+        std::size_t pos = upperName.rfind("_S");
+        if (pos == std::string::npos || pos + 2 >= upperName.size()) {
+            return fallbackState;
+        }
+        pos += 2;
+        int state = 0;
+        bool foundDigit = false;
+        while (pos < upperName.size()) {
+            char c = upperName[pos];
+            if (c < '0' || c > '9') {
+                break;
+            }
+            foundDigit = true;
+            state = (state * 10) + (c - '0');
+            ++pos;
+        }
+        return foundDigit ? state : fallbackState;
+    }
+
+    static AnimationClass ComputeAnimationClass(const std::string& aniName) {
+        AnimationClass result;
+        if (aniName.empty()) {
+            return result;
+        }
+
+        for (unsigned int i = 0; i < 8; i++) {
+            if (strcmp(aniName.c_str(), BlockedAnimationsForAll[i]) == 0) {
+                result.flags |= ANIMATION_BLOCKED;
+                break;
             }
         }
-        return false;
+
+        for (unsigned int i = 0; i < 44; i++) {
+            if (strcmp(aniName.c_str(), AnimationTurning[i]) == 0) {
+                result.flags |= ANIMATION_TURNING;
+                break;
+            }
+        }
+
+        std::string upperName = ToUpper(aniName);
+        if (IsInteractionAnimationName(upperName)) {
+            result.flags |= ANIMATION_INTERACTION;
+            result.mobState = ExtractMobStateFromAnimationName(upperName, 1);
+        }
+        return result;
+    }
+
+    const AnimationClass& ClassifyAnimation(zCModelAni* modelAni) {
+        auto cached = AnimationClassCache.find(modelAni);
+        if (cached != AnimationClassCache.end() && cached->second.aniID == modelAni->aniID) {
+            return cached->second.animationClass;
+        }
+
+        std::string aniName = modelAni->GetAniName().ToChar();
+        auto byName = AnimationClassByName.find(aniName);
+        if (byName == AnimationClassByName.end()) {
+            auto result = ComputeAnimationClass(aniName);
+            byName = AnimationClassByName.emplace(std::move(aniName), result).first;
+        }
+
+        auto& entry = AnimationClassCache[modelAni];
+        entry.aniID = modelAni->aniID;
+        entry.animationClass = byName->second;
+        return entry.animationClass;
+    }
+
+    void ClearAnimationClassCache() {
+        AnimationClassCache.clear();
+    }
+
+    bool IsAniBlockedForAll(zCModelAni* modelAni)
+    {
+        return modelAni && (ClassifyAnimation(modelAni).flags & ANIMATION_BLOCKED) != 0;
     };
 
     bool IsAnimationTurning(zCModelAni* modelAni)
     {
-        auto aniName = modelAni->GetAniName();
-        for (unsigned int i = 0; i < 44; i++)
-        {
-            if (aniName && strcmp(aniName.ToChar(), AnimationTurning[i]) == 0)
-                return true;
-        }
-        return false;
+        return modelAni && (ClassifyAnimation(modelAni).flags & ANIMATION_TURNING) != 0;
     };
 
+    static bool IsAniSyncable(zCModelAni* modelAni)
+    {
+        return (ClassifyAnimation(modelAni).flags & (ANIMATION_BLOCKED | ANIMATION_TURNING)) == 0;
+    }
+
     zCModelAni* GetLastAniFromHistory(oCNpc* npc)
     {
         zCModel* model = npc->GetModel();
@@ -117,7 +219,7 @@ namespace GOTHIC_ENGINE {
 
         for (int i = 1; i <= MAX_ANIHISTORY; i++) {
             auto lastAni = model->aniHistoryList[MAX_ANIHISTORY - i];
-            if (lastAni && !IsAniBlockedForAll(lastAni) && !IsAnimationTurning(lastAni)) {
+            if (lastAni && IsAniSyncable(lastAni)) {
                 return lastAni;
             }
         }
@@ -144,7 +246,7 @@ namespace GOTHIC_ENGINE {
         for each (auto activeAniId in aniIdList)
         {
             zCModelAni* ani = model->GetAniFromAniID(activeAniId);
-            if (ani && !IsAniBlockedForAll(ani) && !IsAnimationTurning(ani)) {
+            if (ani && IsAniSyncable(ani)) {
                 allowedAniIdList.push_back(ani);
             }
         }
@@ -40,6 +40,21 @@ namespace GOTHIC_ENGINE {
 #endif
         PlayersDamageMultipler = CoopConfig.PlayersDamageMultiplier();
         NpcsDamageMultipler = CoopConfig.NpcsDamageMultiplier();
+        SnapshotReplication = CoopConfig.SnapshotReplication();
+        SnapshotIntervalMs = CoopConfig.SnapshotIntervalMs();
+        PositionErrorThreshold = CoopConfig.PositionErrorThreshold();
+        NetworkTickRate = CoopConfig.NetworkTickRate();
+        ApplyBudgetUs = CoopConfig.ApplyBudgetUs();
+        DistributedAuthority = CoopConfig.DistributedAuthority();
+        InterestRadius = CoopConfig.InterestRadius();
+        LodNearDistance = CoopConfig.LodNearDistance();
+        LodFarDistance = CoopConfig.LodFarDistance();
+        LodNearIntervalMs = CoopConfig.LodNearIntervalMs();
+        LodMidIntervalMs = CoopConfig.LodMidIntervalMs();
+        LodFarIntervalMs = CoopConfig.LodFarIntervalMs();
+        PulseBudgetUs = CoopConfig.PulseBudgetUs();
+        CapturePackets = CoopConfig.CapturePackets();
+        VerifyNpcRegistry = CoopConfig.VerifyNpcRegistry();
 
         auto friendInstance = CoopConfig.FriendInstance();
         if (!friendInstance.empty()) {
@@ -53,6 +68,23 @@ namespace GOTHIC_ENGINE {
         }
     }
 
+    // Sampling and packing run on a fixed tick so the amount of traffic does not
+    // follow the frame rate. Several missed ticks in one long frame collapse
+    // into one, since the game state has only been sampled once anyway.
+    static bool ConsumeNetworkTick() {
+        double tickMs = 1000.0 / NetworkTickRate;
+        long long frameMs = LastNetworkTickFrameMs > 0 ? CurrentMs - LastNetworkTickFrameMs : static_cast<long long>(tickMs);
+        LastNetworkTickFrameMs = CurrentMs;
+
+        NetworkTickAccumulatorMs += frameMs;
+        if (NetworkTickAccumulatorMs < tickMs) {
+            return false;
+        }
+
+        NetworkTickAccumulatorMs = fmod(NetworkTickAccumulatorMs, tickMs);
+        return true;
+    }
+
     void Game_Loop() {
         PluginState = "GameLoop";
         if (IsLoadingLevel) {
@@ -67,36 +99,72 @@ namespace GOTHIC_ENGINE {
         SpellCastProcessorLoop();
         ReviveFriendLoop();
 
-        if (CurrentMs > LastNpcListRefreshTime + 1000) {
+        RefreshNpcGrid();
+        if (!NpcRegistryInitialized) {
             BuildGlobalNpcList();
             LastNpcListRefreshTime = CurrentMs;
             PluginState = "GameLoop";
         }
+        else if (VerifyNpcRegistry && CurrentMs > LastNpcListRefreshTime + 1000) {
+            auto missed = BuildGlobalNpcList();
+            if (missed > 0) {
+                CoopLog("[NpcRegistry] Full scan found " + std::to_string(missed) + " NPCs the insert hook missed.\r\n");
+            }
+            LastNpcListRefreshTime = CurrentMs;
+            PluginState = "GameLoop";
+        }
+        RegisterPendingNpcs();
 
         if (CurrentMs > LastUpdateListOfVisibleNpcs + 500) {
             UpdateVisibleNpc();
             LastUpdateListOfVisibleNpcs = CurrentMs;
             PluginState = "GameLoop";
         }
+        UpdateInterestSets();
 
+        bool networkTick = ConsumeNetworkTick();
         if (!IsCoopPaused) {
-            PluginState = "PulseMyself";
-            if (Myself) {
-                Myself->Pulse();
-                Myself->PackUpdate();
+            if (networkTick) {
+                PluginState = "PulseMyself";
+                if (Myself) {
+                    Myself->Pulse();
+                    Myself->PackUpdate();
+                }
             }
 
-            PluginState = "PulseBroadcastNpcs";
-            for (auto p : BroadcastNpcs) {
-                p.second->Pulse();
-                p.second->PackUpdate();
-            }
+            PulseBroadcastNpcs();
 
+            SnapshotProcessorLoop();
+
+            // Expensive updates share one time budget per frame, so the NPCs
+            // closest to the player get theirs first and the rest catch up in
+            // the next frames.
             PluginState = "UpdateSyncNpcs";
+            RemoteApplyBudget.BeginFrame(ApplyBudgetUs);
+            struct NearNpc {
+                RemoteNpc* remoteNpc;
+                float distance;
+            };
+            std::vector<NearNpc> byDistance;
+            byDistance.reserve(SyncNpcs.size());
+            auto playerPos = player->GetPositionWorld();
+            for (auto& p : SyncNpcs) {
+                auto remoteNpc = p.second;
+                float distance = remoteNpc->lastPositionFromServer
+                    ? GetVec3LengthApprox(*remoteNpc->lastPositionFromServer - playerPos)
+                    : FLT_MAX;
+                byDistance.push_back({ remoteNpc, distance });
+            }
+            std::sort(byDistance.begin(), byDistance.end(), [](const NearNpc& a, const NearNpc& b) {
+                return a.distance < b.distance;
+            });
+            for (auto& entry : byDistance) {
+                entry.remoteNpc->Update();
+            }
+            RemoteApplyDeferredLastFrame = RemoteApplyBudget.Deferred();
+
             for (auto it = SyncNpcs.begin(); it != SyncNpcs.end();) {
                 auto npc = it->second;
-                npc->Update();
-
                 if (npc->destroyed) {
                     delete npc;
                     it = SyncNpcs.erase(it);
@@ -200,7 +268,7 @@ namespace GOTHIC_ENGINE {
                 for (auto playerNpcToName : PlayerNpcsCopy) {
                     auto name = playerNpcToName.second;
                     if (SyncNpcs.count(name)) {
-                        SyncNpcs[name]->ReinitCoopFriendNpc();
+                        SyncNpcs[name]->RecreateCoopFriendNpc();
                     }
                 }
             }
@@ -223,7 +291,7 @@ namespace GOTHIC_ENGINE {
         for (auto playerNpcToName : PlayerNpcs) {
             auto name = playerNpcToName.second;
             if (SyncNpcs.count(name)) {
-                SyncNpcs[name]->InitCoopFriendNpc();
+                SyncNpcs[name]->SpawnCoopFriendNpc();
             }
         }
 
@@ -233,6 +301,9 @@ namespace GOTHIC_ENGINE {
     void LoadBegin() {
         IsLoadingLevel = true;
         Myself = NULL;
+        NpcGrid.Clear();
+        PendingNpcRegistrations.clear();
+        ClearAnimationClassCache();
     }
 
     void LoadEnd() {
@@ -261,10 +332,16 @@ namespace GOTHIC_ENGINE {
         }
 
         BroadcastNpcs.clear();
+        ClearNpcAuthority();
+        ClearInterestSets();
+        NpcGrid.Clear();
         UniqueNameToNpcList.clear();
         NpcToUniqueNameList.clear();
         NamesCounter.clear();
         NpcToFirstRoutineWp.clear();
+        NpcRegistryInitialized = false;
+        PendingNpcRegistrations.clear();
+        ClearAnimationClassCache();
         GameChat->Clear();
         LastNpcListRefreshTime = 0;
         LastUpdateListOfVisibleNpcs = 0;
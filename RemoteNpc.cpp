@@ -1,13 +1,5 @@
-#include <cctype>
-
 namespace GOTHIC_ENGINE {
-    float GetVec3LengthApprox(const zVEC3& vec) {
-    #ifdef __G1A
-            return vec.Length();
-    #else
-            return vec.LengthApprox();
-    #endif
-    }
+    bool IsNpcAuthorityLocal(const string& npcName);
 
     class RemoteNpc
     {
@@ -24,19 +16,24 @@ namespace GOTHIC_ENGINE {
         bool isSpawned = false;
         bool hasNpc = false;
         bool hasModel = false;
-        std::vector<PlayerStateUpdatePacket> localUpdates;
+        RemoteUpdateQueue localUpdates;
 
         zVEC3* lastPositionFromServer = NULL;
         float lastHeadingFromServer = -1;
+        InterpolationBuffer motion;
+        long long lastTransformMs = 0;
         int lastHpFromServer = -1;
         int lastMaxHpFromServer = -1;
         int lastWeaponMode = -1;
         int lastWeapon1 = -1;
         int lastWeapon2 = -1;
         int lastArmor = -1;
+        std::uint16_t lastAnimationSequence = 0;
+        bool hasAnimationSequence = false;
         zSTRING lastSpellInstanceName;
         oCItem* spellItem;
-        std::map<oCVob*, bool> syncedNpcItems;
+        std::map<int, oCItem*> itemCache;
+        std::map<int, oCItem*> spellCache;
 
         RemoteNpc(string playerName) {
             name = playerName;
@@ -53,7 +50,6 @@ namespace GOTHIC_ENGINE {
             }
 
             UpdateHasNpcAndHasModel();
-            //RemoveCoopItemsFromGround();
             RespawnOrDestroyBasedOnDistance();
 
             if (npc == NULL && UniqueNameToNpcList.count(name) > 0) {
@@ -68,11 +64,11 @@ namespace GOTHIC_ENGINE {
                 return;
             }
 
-            while (!localUpdates.empty()) {
-                auto update = localUpdates.front();
-                localUpdates.erase(localUpdates.begin());
-
+            localUpdates.Drain([this](const PlayerStateUpdatePacket& update) {
                 auto type = update.updateType;
+                if (IsExpensiveUpdate(type) && !RemoteApplyBudget.TryConsume()) {
+                    return false;
+                }
                 PluginState = "Updating NPC " + name + " TYPE: " + static_cast<int>(type);
 
                 switch (type) {
@@ -158,6 +154,14 @@ namespace GOTHIC_ENGINE {
                     DestroyNpc();
                     break;
                 }
+                case RELEASE_NPC:
+                {
+                    // The NPC stays in the world; only the puppet goes away.
+                    if (!IsCoopPlayer(name)) {
+                        destroyed = true;
+                    }
+                    break;
+                }
                 case SYNC_BODYSTATE:
                 {
                     UpdateBodystate(update);
@@ -180,13 +184,17 @@ namespace GOTHIC_ENGINE {
                 }
 
                 }
-            }
+                return true;
+            });
 
             PluginState = "UpdateSyncNpcs";
             UpdateNpcBasedOnLastDataFromServer();
         }
 
         void UpdateInitialization(const PlayerStateUpdatePacket& update) {
+            // The sender starts a new animation stream with every initialization.
+            hasAnimationSequence = false;
+
             if (npc == NULL) {
                 auto x = update.initNpc.x;
                 auto y = update.initNpc.y;
@@ -206,6 +214,9 @@ namespace GOTHIC_ENGINE {
                 playerHeadModel = headModel;
                 delete lastPositionFromServer;
                 lastPositionFromServer = new zVEC3(x, y, z);
+                motion.Reset();
+                motion.AddPosition(CurrentMs, x, y, z);
+                lastTransformMs = CurrentMs;
 
                 if (IsCoopPlayer(name)) {
                     InitCoopFriendNpc();
@@ -234,22 +245,66 @@ namespace GOTHIC_ENGINE {
 
             delete lastPositionFromServer;
             lastPositionFromServer = new zVEC3(x, y, z);
+            TouchTransform();
+            motion.AddPosition(CurrentMs, x, y, z, update.pos.vx, update.pos.vy, update.pos.vz);
         }
 
         void UpdateAngle(const PlayerStateUpdatePacket& update) {
             auto h = update.heading.heading;
             lastHeadingFromServer = h;
-            if (hasModel) {
-                npc->ResetRotationsWorld();
-                npc->RotateWorldY(h);
+            TouchTransform();
+            motion.AddHeading(CurrentMs, h);
+        }
+
+        long long TransformStalenessMs() const {
+            return lastTransformMs > 0 ? CurrentMs - lastTransformMs : 0;
+        }
+
+        bool IsTransformStale() const {
+            return TransformStalenessMs() > TRANSFORM_STALE_MS;
+        }
+
+        // After a stale period the history no longer describes the sender, so
+        // the next keyframe is shown as is instead of blended from it.
+        void TouchTransform() {
+            if (IsTransformStale()) {
+                motion.Reset();
             }
+            lastTransformMs = CurrentMs;
         }
 
         void UpdateAnimation(const PlayerStateUpdatePacket& update) {
-            if (hasModel) {
-                auto a = update.animation.animationId;
-                npc->GetModel()->StartAni(a, COOP_MAGIC_NUMBER);
-                TrySyncMobInteraction(update.animation.animationName);
+            const auto& entries = update.animation.entries;
+            if (entries.empty()) {
+                return;
+            }
+
+            auto newestStartTick = entries.back().startTick;
+            auto sequence = static_cast<std::uint16_t>(update.animation.sequence - (entries.size() - 1));
+            for (const auto& entry : entries) {
+                auto entrySequence = sequence++;
+                if (hasAnimationSequence && static_cast<std::int16_t>(entrySequence - lastAnimationSequence) <= 0) {
+                    continue;
+                }
+                lastAnimationSequence = entrySequence;
+                hasAnimationSequence = true;
+
+                if (!hasModel) {
+                    continue;
+                }
+
+                // An entry recovered from a lost datagram is not played when a
+                // newer animation had long replaced it on the sender, but mob
+                // interactions it started still have to happen.
+                auto model = npc->GetModel();
+                if (newestStartTick - entry.startTick <= static_cast<std::uint32_t>(ANIMATION_STREAM_STALE_MS)) {
+                    model->StartAni(entry.animationId, COOP_MAGIC_NUMBER);
+                }
+
+                auto ani = model->GetAniFromAniID(entry.animationId);
+                if (ani) {
+                    TrySyncMobInteraction(ani);
+                }
             }
         }
 
@@ -337,24 +392,25 @@ namespace GOTHIC_ENGINE {
 
         void UpdateArmor(const PlayerStateUpdatePacket& update) {
             if (hasNpc) {
-                auto armor = update.armor.armor;
+                int insIndex = GetItemInstanceIndex(update.armor.armor);
 
                 auto currentArmor = npc->GetEquippedArmor();
+                if (currentArmor && currentArmor->GetInstance() == insIndex) {
+                    lastArmor = insIndex;
+                    return;
+                }
+
                 if (currentArmor) {
                     lastArmor = -1;
                     npc->UnequipItem(currentArmor);
                 }
 
-                if (armor != "NULL") {
-                    int insIndex = parser->GetIndex(armor.c_str());
-                    if (insIndex > 0) {
-                        auto newArmor = CreateCoopItem(insIndex);
-                        if (newArmor) {
-                            lastArmor = insIndex;
-                            npc->Equip(newArmor);
-                        }
+                if (insIndex > 0) {
+                    auto newArmor = GetCachedItem(insIndex);
+                    if (newArmor) {
+                        lastArmor = insIndex;
+                        npc->Equip(newArmor);
                     }
-
                 }
             }
         }
@@ -368,58 +424,24 @@ namespace GOTHIC_ENGINE {
 
         void UpdateOverlays(const PlayerStateUpdatePacket& update) {
             if (hasNpc) {
-                zCArray<int> overlaysNew;
-
-                for (auto overlayId : update.overlays.overlayIds) {
-                    overlaysNew.InsertEnd(overlayId);
-                }
-
-                if (!npc->CompareOverlaysArray(overlaysNew))
-                {
-                    npc->ApplyOverlaysArray(overlaysNew);
-                }
+                const auto& overlays = update.overlays.overlays;
+                npc->ApplyOverlays(overlays.data(), static_cast<int>(overlays.size()));
             }
         }
 
         void UpdateMagicSetup(const PlayerStateUpdatePacket& update) {
-            if (hasNpc && hasModel) {
-                auto spellInstanceName = update.magicSetup.spellInstanceName;
-                oCMag_Book* book = npc->GetSpellBook();
-                if (book)
-                {
-                    auto selectedSpell = book->GetSelectedSpell();
-                    if (selectedSpell) {
-                        auto selectedSpellItem = book->GetSpellItem(selectedSpell);
-                        if (selectedSpellItem) {
-                            selectedSpellItem->RemoveVobFromWorld();
-                        }
-                        selectedSpell->Kill();
-                    }
-
-                    book->spellitems.EmptyList();
-                    book->spells.EmptyList();
-                }
-
-                if (spellInstanceName.compare("NULL") != 0) {
-                    int insIndex = parser->GetIndex(spellInstanceName.c_str());
-                    if (insIndex > 0) {
-                        auto spellItem = CreateCoopItem(insIndex);
-                        if (spellItem) {
-                            npc->DoPutInInventory(spellItem);
-                            npc->Equip(spellItem);
-
-                            oCMag_Book* book = npc->GetSpellBook();
-                            if (book) {
-                                book->Open(0);
-                            }
-                        }
-                    }
-                }
+            int spellInstanceId = GetItemInstanceIndex(update.magicSetup.spellInstanceName);
+            if (spellInstanceId <= 0) {
+                ClearSpellSelection();
+                return;
             }
+            SelectCachedSpell(spellInstanceId);
         }
 
-        void EnsureSpellSetup(int spellInstanceId) {
-            if (!hasNpc || !hasModel || spellInstanceId <= 0) {
+        // The caster left magic mode ("NULL" setup): stop the selected spell and
+        // close the book, keeping the prepared spells for the next time.
+        void ClearSpellSelection() {
+            if (!hasNpc || !hasModel) {
                 return;
             }
 
@@ -427,81 +449,133 @@ namespace GOTHIC_ENGINE {
             if (!book) {
                 return;
             }
+            if (book->GetSelectedSpell()) {
+                book->KillSelectedSpell();
+            }
+            if (book->open) {
+                book->Close(0);
+            }
+        }
 
-            auto selectedSpell = book->GetSelectedSpell();
-            if (selectedSpell) {
-                auto selectedSpellItem = book->GetSpellItem(selectedSpell);
-                if (selectedSpellItem) {
-                    int currentInstanceId = parser->GetIndex(selectedSpellItem->GetInstanceName());
-                    if (currentInstanceId == spellInstanceId) {
-                        return;
-                    }
-                }
+        // Spell items stay registered in the spell book once prepared, so a
+        // caster switching between spells only moves the selection. Returns
+        // the spell's index in the book, or -1.
+        int SelectCachedSpell(int spellInstanceId) {
+            if (!hasNpc || !hasModel || spellInstanceId <= 0) {
+                return -1;
             }
 
-            if (selectedSpell) {
-                auto selectedSpellItem = book->GetSpellItem(selectedSpell);
-                if (selectedSpellItem) {
-                    selectedSpellItem->RemoveVobFromWorld();
+            oCMag_Book* book = npc->GetSpellBook();
+            if (book) {
+                auto selectedSpell = book->GetSelectedSpell();
+                auto selectedSpellItem = selectedSpell ? book->GetSpellItem(selectedSpell) : NULL;
+                if (selectedSpellItem && selectedSpellItem->GetInstance() == spellInstanceId) {
+                    return book->GetSelectedSpellNr();
                 }
-                selectedSpell->Kill();
             }
 
-            book->spellitems.EmptyList();
-            book->spells.EmptyList();
+            oCItem* spellItem = NULL;
+            auto cached = spellCache.find(spellInstanceId);
+            if (cached != spellCache.end()) {
+                spellItem = cached->second;
+            }
+            else {
+                if (book && spellCache.size() >= REMOTE_SPELL_CACHE_SIZE) {
+                    EvictCachedSpell(book);
+                }
 
-            auto spellItem = CreateCoopItem(spellInstanceId);
-            if (spellItem) {
+                spellItem = CreateCoopItem(spellInstanceId);
+                if (!spellItem) {
+                    return -1;
+                }
                 npc->DoPutInInventory(spellItem);
                 npc->Equip(spellItem);
+                spellCache[spellInstanceId] = spellItem;
+                book = npc->GetSpellBook();
+            }
 
-                oCMag_Book* refreshedBook = npc->GetSpellBook();
-                if (refreshedBook) {
-                    refreshedBook->Open(0);
+            if (!book) {
+                return -1;
+            }
+
+            for (int i = 0; i < book->GetNoOfSpells(); i++) {
+                if (book->GetSpellItem(i) == spellItem) {
+                    book->SetFrontSpell(i);
+                    if (!book->open) {
+                        book->Open(0);
+                    }
+                    return i;
                 }
             }
+
+            // The book lost the item, e.g. the NPC unequipped it; prepare it again next time.
+            ReleaseSpellItem(book, spellItem);
+            spellCache.erase(spellInstanceId);
+            return -1;
+        }
+
+        void EvictCachedSpell(oCMag_Book* book) {
+            auto selectedSpell = book->GetSelectedSpell();
+            auto selectedSpellItem = selectedSpell ? book->GetSpellItem(selectedSpell) : NULL;
+            for (auto it = spellCache.begin(); it != spellCache.end(); ++it) {
+                if (it->second != selectedSpellItem) {
+                    ReleaseSpellItem(book, it->second);
+                    spellCache.erase(it);
+                    return;
+                }
+            }
+        }
+
+        // Unequips a prepared spell and takes its item out of the book and the inventory.
+        void ReleaseSpellItem(oCMag_Book* book, oCItem* item) {
+            if (!item) {
+                return;
+            }
+            if (item->HasFlag(ITM_FLAG_ACTIVE)) {
+                npc->UnequipItem(item);
+            }
+            book->DeRegister(item);
+            ReleaseItem(item);
         }
 
         void UpdateHand(const PlayerStateUpdatePacket& update) {
             if (!hasModel) {
                 return;
             }
-            auto leftItem = update.hand.leftItem;
-            auto rightItem = update.hand.rightItem;
 
-            auto leftHandItem = npc->GetLeftHand();
-            if (leftHandItem)
-            {
-                npc->SetLeftHand(nullptr);
-                leftHandItem->RemoveVobFromWorld();
-                syncedNpcItems.erase(leftHandItem);
-            }
+            UpdateHandItem(true, GetItemInstanceIndex(update.hand.leftItem));
+            UpdateHandItem(false, GetItemInstanceIndex(update.hand.rightItem));
+        }
 
-            if (leftItem != "NULL") {
-                int insIndex = parser->GetIndex(leftItem.c_str());
-                if (insIndex > 0) {
-                    auto newItem = CreateCoopItem(insIndex);
-                    if (newItem) {
-                        syncedNpcItems[newItem] = true;
-                        npc->SetLeftHand(newItem);
-                    }
+        void UpdateHandItem(bool leftHand, int insIndex) {
+            auto current = leftHand ? npc->GetLeftHand() : npc->GetRightHand();
+            if (insIndex > 0) {
+                auto cached = itemCache.find(insIndex);
+                if (cached != itemCache.end() && cached->second == current) {
+                    return;
                 }
             }
+            else if (!current) {
+                return;
+            }
 
-            auto rightHandItem = npc->GetRightHand();
-            if (rightHandItem)
-            {
-                npc->SetRightHand(nullptr);
-                rightHandItem->RemoveVobFromWorld();
-                syncedNpcItems.erase(rightHandItem);
+            if (current) {
+                if (leftHand) {
+                    npc->SetLeftHand(nullptr);
+                }
+                else {
+                    npc->SetRightHand(nullptr);
+                }
+                current->RemoveVobFromWorld();
             }
 
-            if (rightItem != "NULL") {
-                int insIndex = parser->GetIndex(rightItem.c_str());
-                if (insIndex > 0) {
-                    auto newItem = CreateCoopItem(insIndex);
-                    if (newItem) {
-                        syncedNpcItems[newItem] = true;
+            if (insIndex > 0) {
+                auto newItem = GetCachedItem(insIndex);
+                if (newItem) {
+                    if (leftHand) {
+                        npc->SetLeftHand(newItem);
+                    }
+                    else {
                         npc->SetRightHand(newItem);
                     }
                 }
@@ -510,52 +584,88 @@ namespace GOTHIC_ENGINE {
 
         void UpdateWeapons(const PlayerStateUpdatePacket& update) {
             if (hasModel) {
-                auto weapon1 = update.weapons.weapon1;
-                auto weapon2 = update.weapons.weapon2;
-
-                auto currentWeapon1 = npc->GetEquippedMeleeWeapon();
-                auto currentWeapon2 = npc->GetEquippedRangedWeapon();
-
-                if (currentWeapon1) {
-                    npc->UnequipItem(currentWeapon1);
-                    currentWeapon1->RemoveVobFromWorld();
-                    syncedNpcItems.erase(currentWeapon1);
-                    lastWeapon1 = -1;
-                }
-
-                if (currentWeapon2) {
-                    npc->UnequipItem(currentWeapon2);
-                    currentWeapon2->RemoveVobFromWorld();
-                    syncedNpcItems.erase(currentWeapon2);
-                    lastWeapon2 = -1;
-                }
-
-                if (weapon1 != "NULL") {
-                    int insIndex = parser->GetIndex(weapon1.c_str());
-                    if (insIndex > 0) {
-                        auto newWeapon = CreateCoopItem(insIndex);
-                        if (newWeapon) {
-                            lastWeapon1 = insIndex;
-                            npc->Equip(newWeapon);
-                            syncedNpcItems[newWeapon] = true;
-                        }
-                    }
+                UpdateEquippedWeapon(npc->GetEquippedMeleeWeapon(), GetItemInstanceIndex(update.weapons.weapon1), lastWeapon1);
+                UpdateEquippedWeapon(npc->GetEquippedRangedWeapon(), GetItemInstanceIndex(update.weapons.weapon2), lastWeapon2);
+            }
+        }
+
+        void UpdateEquippedWeapon(oCItem* current, int insIndex, int& lastWeapon) {
+            if (current && current->GetInstance() == insIndex) {
+                lastWeapon = insIndex;
+                return;
+            }
 
+            if (current) {
+                npc->UnequipItem(current);
+                current->RemoveVobFromWorld();
+                lastWeapon = -1;
+            }
+
+            if (insIndex > 0) {
+                auto newWeapon = GetCachedItem(insIndex);
+                if (newWeapon) {
+                    lastWeapon = insIndex;
+                    npc->Equip(newWeapon);
                 }
+            }
+        }
 
-                if (weapon2 != "NULL") {
-                    int insIndex = parser->GetIndex(weapon2.c_str());
-                    if (insIndex > 0) {
-                        auto newWeapon = CreateCoopItem(insIndex);
-                        if (newWeapon) {
-                            lastWeapon2 = insIndex;
-                            npc->Equip(newWeapon);
-                            syncedNpcItems[newWeapon] = true;
-                        }
-                    }
+        int GetItemInstanceIndex(const std::string& instanceName) {
+            if (instanceName == "NULL") {
+                return 0;
+            }
+            int insIndex = parser->GetIndex(instanceName.c_str());
+            return insIndex > 0 ? insIndex : 0;
+        }
+
+        // Items this NPC equipped or held are kept by instance index, so switching
+        // back to one reuses the existing vob instead of creating another.
+        // At most five of them are in use at once (two hands, armor, two
+        // weapons), so a full cache always has one to evict.
+        static_assert(REMOTE_ITEM_CACHE_SIZE > 5, "The item cache must hold more items than an NPC can use at once.");
+
+        oCItem* GetCachedItem(int insIndex) {
+            auto cached = itemCache.find(insIndex);
+            if (cached != itemCache.end()) {
+                return cached->second;
+            }
 
+            while (itemCache.size() >= REMOTE_ITEM_CACHE_SIZE) {
+                auto evicted = itemCache.end();
+                for (auto it = itemCache.begin(); it != itemCache.end(); ++it) {
+                    if (!IsItemInUse(it->second)) {
+                        evicted = it;
+                        break;
+                    }
+                }
+                if (evicted == itemCache.end()) {
+                    break;
                 }
+                ReleaseItem(evicted->second);
+                itemCache.erase(evicted);
+            }
+
+            auto item = CreateCoopItem(insIndex);
+            if (item) {
+                itemCache[insIndex] = item;
+            }
+            return item;
+        }
+
+        // Takes an item this NPC no longer uses out of its inventory and the world.
+        void ReleaseItem(oCItem* item) {
+            if (!item) {
+                return;
+            }
+            if (npc && npc->IsInInv(item, 1)) {
+                npc->DoRemoveFromInventory(item);
             }
+            item->RemoveVobFromWorld();
+        }
+
+        bool IsItemInUse(oCItem* item) {
+            return npc && (item == npc->GetLeftHand() || item == npc->GetRightHand() || item == npc->GetEquippedArmor()
+                || item == npc->GetEquippedMeleeWeapon() || item == npc->GetEquippedRangedWeapon());
         }
 
         void UpdateSpellCasts(const PlayerStateUpdatePacket& update) {
@@ -572,13 +682,13 @@ namespace GOTHIC_ENGINE {
                     auto spellLevel = c.spellLevel;
                     auto spellCharge = c.spellCharge;
 
-                    EnsureSpellSetup(spellInstanceId);
+                    int spellIndex = SelectCachedSpell(spellInstanceId);
                     book = npc->GetSpellBook();
-                    if (!book) {
+                    if (!book || spellIndex < 0) {
                         continue;
                     }
 
-                    auto selectedSpell = book->GetSelectedSpell();
+                    auto selectedSpell = book->GetSpell(spellIndex);
                     if (!selectedSpell) {
                         continue;
                     }
@@ -586,11 +696,6 @@ namespace GOTHIC_ENGINE {
                     selectedSpell->spellLevel = spellLevel;
                     selectedSpell->SetInvestedMana(spellCharge);
 
-                    int spellIndex = book->GetSelectedSpellNr();
-                    if (spellIndex < 0) {
-                        spellIndex = 0;
-                    }
-
                     if (!target.empty() && UniqueNameToNpcList.count(target.c_str()) > 0) {
                         book->Spell_Setup(spellIndex, npc, UniqueNameToNpcList[target.c_str()]);
                     }
@@ -679,7 +784,7 @@ namespace GOTHIC_ENGINE {
                 // attack any world npc (eg. client attacks Moe, Cavalorn attacks goblin, wolf attacks sheep)
                 auto targetNpcEntry = UniqueNameToNpcList.find(target.c_str());
                 if (targetNpcEntry == UniqueNameToNpcList.end()) {
-                    BuildGlobalNpcList();
+                    RegisterPendingNpcs();
                     targetNpcEntry = UniqueNameToNpcList.find(target.c_str());
                 }
 
@@ -709,7 +814,7 @@ namespace GOTHIC_ENGINE {
                             targetNpc->SetAttribute(NPC_ATR_HITPOINTS, 999999);
                             targetNpc->GetEM(false)->OnDamage(targetNpc, npc, COOP_MAGIC_NUMBER, damageMode, targetNpc->GetPositionWorld());
                         }
-                        if (ServerThread) {
+                        if (IsNpcAuthorityLocal(target.c_str())) {
                             const int remainingHealth = health - static_cast<int>(damage);
                             targetNpc->SetAttribute(NPC_ATR_HITPOINTS, remainingHealth > 0 ? remainingHealth : 0);
                         }
@@ -824,13 +929,18 @@ namespace GOTHIC_ENGINE {
                 ogame->spawnman->DeleteNpc(npc);
                 destroyed = true;
                 npc = NULL;
+                itemCache.clear();
+                spellCache.clear();
             }
         }
 
         void UpdateNpcBasedOnLastDataFromServer() {
             if (npc && hasModel) {
+                auto interpolated = motion.Evaluate(CurrentMs);
                 if (lastPositionFromServer) {
-                    UpdateNpcPosition();
+                    UpdateNpcPosition(interpolated.hasPosition
+                        ? zVEC3(interpolated.x, interpolated.y, interpolated.z)
+                        : *lastPositionFromServer);
                 }
 
                 if (lastHpFromServer != -1 && lastHpFromServer != npc->GetAttribute(NPC_ATR_HITPOINTS)) {
@@ -844,21 +954,38 @@ namespace GOTHIC_ENGINE {
                 }
 
                 if (lastHeadingFromServer != -1) {
-                    npc->ResetRotationsWorld();
-                    npc->RotateWorldY(lastHeadingFromServer);
+                    UpdateNpcHeading(interpolated.hasHeading ? interpolated.heading : lastHeadingFromServer);
                 }
 
                 if (IsCoopPlayer(name)) {
                     static int AIV_PARTYMEMBER = GetPartyMemberID();
-                    npc->aiscriptvars[AIV_PARTYMEMBER] = True;
+                    if (npc->aiscriptvars[AIV_PARTYMEMBER] != True) {
+                        npc->aiscriptvars[AIV_PARTYMEMBER] = True;
+                    }
                 }
             }
         }
 
-        void UpdateNpcPosition() {
+        // The engine moves and turns NPCs on its own between frames, so targets
+        // are compared with the NPC itself rather than with what was last set.
+        void UpdateNpcHeading(float heading) {
+            float delta = fmod(heading - GetHeading(npc) + 540.0f, 360.0f) - 180.0f;
+            if (delta > -REMOTE_HEADING_TOLERANCE && delta < REMOTE_HEADING_TOLERANCE) {
+                return;
+            }
+
+            npc->ResetRotationsWorld();
+            npc->RotateWorldY(heading);
+        }
+
+        void UpdateNpcPosition(const zVEC3& pos) {
             auto currentPosition = npc->GetPositionWorld();
-            auto dist = static_cast<int>(GetVec3LengthApprox(*lastPositionFromServer - currentPosition));
-            auto pos = *lastPositionFromServer;
+            auto offset = pos - currentPosition;
+            if (offset.n[0] * offset.n[0] + offset.n[1] * offset.n[1] + offset.n[2] * offset.n[2] < REMOTE_POSITION_TOLERANCE * REMOTE_POSITION_TOLERANCE) {
+                return;
+            }
+
+            auto dist = static_cast<int>(GetVec3LengthApprox(offset));
 
             if (dist < 200) {
                 npc->SetCollDet(FALSE);
@@ -891,16 +1018,46 @@ namespace GOTHIC_ENGINE {
             hasModel = npc && npc->GetModel() && npc->vobLeafList.GetNum() > 0;
         }
 
+        // Friend NPCs stay created, dressed and equipped while they are out of
+        // range or between levels; only their world membership changes.
         void ReinitCoopFriendNpc() {
+            if (npc) {
+                DespawnCoopFriendNpc();
+                SpawnCoopFriendNpc();
+            }
+        }
+
+        void RecreateCoopFriendNpc() {
             if (npc) {
                 PlayerNpcs.erase(npc);
                 PlayerNameToNpc.erase(name);
                 ogame->spawnman->DeleteNpc(npc);
                 npc = NULL;
+                itemCache.clear();
+                spellCache.clear();
                 InitCoopFriendNpc();
             }
         }
 
+        void SpawnCoopFriendNpc() {
+            if (!npc || !npc->GetModel() || !lastPositionFromServer) {
+                InitCoopFriendNpc();
+                return;
+            }
+
+            ogame->spawnman->InsertNpc(npc, *lastPositionFromServer);
+            isSpawned = true;
+
+            if (lastWeaponMode > 0) {
+                npc->SetWeaponMode2(lastWeaponMode);
+            }
+        }
+
+        void DespawnCoopFriendNpc() {
+            ogame->spawnman->DeleteNpc(npc);
+            isSpawned = false;
+        }
+
         void InitCoopFriendNpc() {
             int instanceId = GetFriendDefaultInstanceId();
             if (instanceId <= 0) {
@@ -970,18 +1127,24 @@ namespace GOTHIC_ENGINE {
             }
 
             if (lastWeapon1 > 0) {
-                auto weapon = CreateCoopItem(lastWeapon1);
-                npc->Equip(weapon);
+                auto weapon = GetCachedItem(lastWeapon1);
+                if (weapon) {
+                    npc->Equip(weapon);
+                }
             }
 
             if (lastWeapon2 > 0) {
-                auto weapon = CreateCoopItem(lastWeapon2);
-                npc->Equip(weapon);
+                auto weapon = GetCachedItem(lastWeapon2);
+                if (weapon) {
+                    npc->Equip(weapon);
+                }
             }
 
             if (lastArmor > 0) {
-                auto armor = CreateCoopItem(lastArmor);
-                npc->Equip(armor);
+                auto armor = GetCachedItem(lastArmor);
+                if (armor) {
+                    npc->Equip(armor);
+                }
             }
 
             if (lastWeaponMode > 0) {
@@ -997,47 +1160,25 @@ namespace GOTHIC_ENGINE {
             PlayerNameToNpc[name] = npc;
         }
 
-        void RemoveCoopItemsFromGround() {
-            if (hasNpc && syncedNpcItems.size() > 0) {
-                auto rightItem = npc->GetRightHand();
-                auto leftItem = npc->GetLeftHand();
-                auto currentWeapon1 = npc->GetEquippedMeleeWeapon();
-                auto currentWeapon2 = npc->GetEquippedRangedWeapon();
-
-                for (auto syncedItem : syncedNpcItems) {
-                    auto item = syncedItem.first;
-
-                    if (!item) {
-                        syncedNpcItems.erase(item);
-                    }
-
-                    if (item != leftItem && item != rightItem && item != currentWeapon1 && item != currentWeapon2) {
-                        item->RemoveVobFromWorld();
-                        syncedNpcItems.erase(item);
-                    }
-                }
-            }
-        }
-
         void RespawnOrDestroyBasedOnDistance() {
             if (hasNpc && lastPositionFromServer) {
-                float dist = GetVec3LengthApprox(*lastPositionFromServer - player->GetPositionWorld());
+                float distSquared = GetVec3LengthSquared(*lastPositionFromServer - player->GetPositionWorld());
+                float broadcastSquared = static_cast<float>(BROADCAST_DISTANCE) * BROADCAST_DISTANCE;
 
                 if (IsCoopPlayer(name)) {
-                    if (dist > BROADCAST_DISTANCE && isSpawned) {
-                        ogame->spawnman->DeleteNpc(npc);
-                        isSpawned = false;
+                    float despawnDistance = static_cast<float>(BROADCAST_DISTANCE + COOP_FRIEND_DESPAWN_MARGIN);
+                    if (distSquared > despawnDistance * despawnDistance && isSpawned) {
+                        DespawnCoopFriendNpc();
                     }
-                    if (dist < BROADCAST_DISTANCE && (!isSpawned || !hasModel)) {
-                        InitCoopFriendNpc();
-                        isSpawned = true;
+                    if (distSquared < broadcastSquared && (!isSpawned || !hasModel) && RemoteApplyBudget.TryConsume()) {
+                        SpawnCoopFriendNpc();
                     }
                 }
-                else if (dist > BROADCAST_DISTANCE * 1.5) {
+                else if (distSquared > broadcastSquared * 2.25f) {
                     destroyed = true;
                     return;
                 }
-                else if (dist < BROADCAST_DISTANCE && !hasModel) {
+                else if (distSquared < broadcastSquared && !hasModel && RemoteApplyBudget.TryConsume()) {
                     ogame->spawnman->InsertNpc(npc, *lastPositionFromServer);
                 }
             }
@@ -1058,47 +1199,12 @@ namespace GOTHIC_ENGINE {
         }
 
     private:
-        static std::string ToUpper(std::string value) {
-            for (char& c : value) {
-                c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
-            }
-            return value;
-        }
-
-        static bool IsInteractionAnimationName(const std::string& animationName) {
-            if (animationName.empty()) {
-                return false;
-            }
-            const std::string upperName = ToUpper(animationName);
-            return upperName.find("DOOR") != std::string::npos
-                || upperName.find("LEVER") != std::string::npos
-                || upperName.find("TOUCHPLATE") != std::string::npos
-                || upperName.find("VWHEEL") != std::string::npos;
-        }
-
-        static int ExtractMobStateFromAnimationName(const std::string& animationName, int fallbackState) {
-            const std::string upperName = ToUpper(animationName);
-            std::size_t pos = upperName.rfind("_S");
-            if (pos == std::string::npos || pos + 2 >= upperName.size()) {
-                return fallbackState;
-            }
-            pos += 2;
-            int state = 0;
-            bool foundDigit = false;
-            while (pos < upperName.size()) {
-                char c = upperName[pos];
-                if (c < '0' || c > '9') {
-                    break;
-                }
-                foundDigit = true;
-                state = (state * 10) + (c - '0');
-                ++pos;
+        void TrySyncMobInteraction(zCModelAni* ani) {
+            if (!npc) {
+                return;
             }
-            return foundDigit ? state : fallbackState;
-        }
-
-        void TrySyncMobInteraction(const std::string& animationName) {
-            if (!npc || !IsInteractionAnimationName(animationName)) {
+            const auto& animationClass = ClassifyAnimation(ani);
+            if ((animationClass.flags & ANIMATION_INTERACTION) == 0) {
                 return;
             }
             auto mob = npc->GetInteractMob();
@@ -1108,8 +1214,7 @@ namespace GOTHIC_ENGINE {
             if (!mob) {
                 return;
             }
-            const int targetState = ExtractMobStateFromAnimationName(animationName, 1);
-            mob->AI_UseMobToState(npc, targetState);
+            mob->AI_UseMobToState(npc, animationClass.mobState);
         }
     };
 }
\ No newline at end of file
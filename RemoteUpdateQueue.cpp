@@ -0,0 +1,268 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace GOTHIC_ENGINE {
+    constexpr std::size_t kUpdateTypeCount = static_cast<std::size_t>(RELEASE_NPC) + 1;
+
+    // State updates replace whatever the previous update of the same type said,
+    // so only the newest one has to be applied. Everything else is an event.
+    inline bool IsCoalescedUpdate(UpdateType type) {
+        switch (type) {
+        case SYNC_POS:
+        case SYNC_HEADING:
+        case SYNC_WEAPON_MODE:
+        case SYNC_HP:
+        case SYNC_TALENTS:
+        case SYNC_PROTECTIONS:
+        case SYNC_ARMOR:
+        case SYNC_MAGIC_SETUP:
+        case SYNC_HAND:
+        case SYNC_WEAPONS:
+        case SYNC_TIME:
+        case SYNC_BODYSTATE:
+        case SYNC_OVERLAYS:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // Updates that create vobs, load visuals or re-init the animation
+    // controller. They are spread over frames by ApplyBudget.
+    inline bool IsExpensiveUpdate(UpdateType type) {
+        switch (type) {
+        case INIT_NPC:
+        case SYNC_ARMOR:
+        case SYNC_WEAPONS:
+        case SYNC_HAND:
+        case SYNC_MAGIC_SETUP:
+        case SYNC_OVERLAYS:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // Wall-clock budget for expensive work in one frame. The first expensive
+    // operation of a frame is always allowed so a backlog keeps draining.
+    class ApplyBudget {
+    public:
+        void BeginFrame(int budgetUs) {
+            start = std::chrono::steady_clock::now();
+            limitUs = budgetUs;
+            spent = 0;
+            deferred = 0;
+        }
+
+        bool TryConsume() {
+            if (spent > 0 && ElapsedUs() >= limitUs) {
+                deferred++;
+                return false;
+            }
+            spent++;
+            return true;
+        }
+
+        int Deferred() const {
+            return deferred;
+        }
+
+    private:
+        long long ElapsedUs() const {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        long long limitUs = 0;
+        int spent = 0;
+        int deferred = 0;
+    };
+
+    // Updates received for one remote NPC and not applied yet. State updates
+    // keep one slot per type holding the newest value; events (init, animations,
+    // attacks, spell casts, drops, revive, destroy) are kept in arrival order in
+    // a ring. Every entry carries a sequence number, so Drain applies a backlog
+    // in one pass in the order the newest state and the events arrived.
+    class RemoteUpdateQueue {
+    public:
+        void Push(const PlayerStateUpdatePacket& update) {
+            auto type = static_cast<std::size_t>(update.updateType);
+            if (type >= kUpdateTypeCount) {
+                return;
+            }
+
+            auto sequence = ++lastSequence;
+            if (IsCoalescedUpdate(update.updateType)) {
+                auto& slot = states[type];
+                if (!slot.pending) {
+                    slot.pending = true;
+                    pendingStates++;
+                }
+                slot.sequence = sequence;
+                slot.update = update;
+                return;
+            }
+
+            if (eventCount == events.size()) {
+                GrowEvents();
+            }
+            auto& entry = events[(eventStart + eventCount) & (events.size() - 1)];
+            entry.sequence = sequence;
+            entry.update = update;
+            eventCount++;
+        }
+
+        bool Empty() const {
+            return pendingStates == 0 && eventCount == 0;
+        }
+
+        std::size_t Size() const {
+            return pendingStates + eventCount;
+        }
+
+        // Hands every pending update to apply and empties the queue. apply
+        // returns false to defer an update; deferred updates stay queued ahead
+        // of anything newer, as do updates pushed while draining.
+        template <typename ApplyFn>
+        void Drain(ApplyFn&& apply) {
+            if (Empty()) {
+                return;
+            }
+
+            drainStates.clear();
+            for (std::size_t type = 0; type < kUpdateTypeCount; type++) {
+                auto& slot = states[type];
+                if (!slot.pending) {
+                    continue;
+                }
+                Entry entry;
+                entry.sequence = slot.sequence;
+                entry.update = std::move(slot.update);
+                slot.pending = false;
+                InsertBySequence(drainStates, std::move(entry));
+            }
+            pendingStates = 0;
+
+            drainEvents.clear();
+            for (std::size_t i = 0; i < eventCount; i++) {
+                drainEvents.push_back(std::move(events[(eventStart + i) & (events.size() - 1)]));
+            }
+            eventStart = 0;
+            eventCount = 0;
+
+            std::size_t state = 0;
+            std::size_t event = 0;
+            std::size_t deferredEvents = 0;
+            while (state < drainStates.size() || event < drainEvents.size()) {
+                bool takeState = event == drainEvents.size()
+                    || (state < drainStates.size() && drainStates[state].sequence < drainEvents[event].sequence);
+                auto& entry = takeState ? drainStates[state++] : drainEvents[event++];
+                // Events keep their relative order: once one is deferred, the
+                // ones after it wait as well.
+                if ((takeState || deferredEvents == 0) && apply(entry.update)) {
+                    continue;
+                }
+
+                if (takeState) {
+                    Requeue(entry);
+                }
+                else if (&drainEvents[deferredEvents] != &entry) {
+                    drainEvents[deferredEvents++] = std::move(entry);
+                }
+                else {
+                    deferredEvents++;
+                }
+            }
+
+            if (deferredEvents > 0) {
+                RequeueEventsFront(deferredEvents);
+            }
+        }
+
+        void Clear() {
+            for (auto& slot : states) {
+                slot.pending = false;
+            }
+            pendingStates = 0;
+            eventStart = 0;
+            eventCount = 0;
+        }
+
+    private:
+        struct Entry {
+            std::uint64_t sequence = 0;
+            PlayerStateUpdatePacket update;
+        };
+
+        struct StateSlot {
+            bool pending = false;
+            std::uint64_t sequence = 0;
+            PlayerStateUpdatePacket update;
+        };
+
+        // A newer value pushed while draining wins over the deferred one.
+        void Requeue(Entry& entry) {
+            auto& slot = states[static_cast<std::size_t>(entry.update.updateType)];
+            if (slot.pending) {
+                return;
+            }
+            slot.pending = true;
+            slot.sequence = entry.sequence;
+            slot.update = std::move(entry.update);
+            pendingStates++;
+        }
+
+        // Puts the first count drained events back ahead of the events that
+        // were pushed during the drain.
+        void RequeueEventsFront(std::size_t count) {
+            std::size_t pushed = eventCount;
+            for (std::size_t i = 0; i < pushed; i++) {
+                drainEvents.push_back(std::move(events[(eventStart + i) & (events.size() - 1)]));
+            }
+            eventStart = 0;
+            eventCount = 0;
+
+            std::size_t total = count + pushed;
+            while (events.size() < total) {
+                GrowEvents();
+            }
+            for (std::size_t i = 0; i < count; i++) {
+                events[i] = std::move(drainEvents[i]);
+            }
+            for (std::size_t i = 0; i < pushed; i++) {
+                events[count + i] = std::move(drainEvents[drainEvents.size() - pushed + i]);
+            }
+            eventCount = total;
+        }
+
+        // At most one entry per update type, so insertion sort is enough.
+        static void InsertBySequence(std::vector<Entry>& entries, Entry&& entry) {
+            entries.push_back(std::move(entry));
+            for (std::size_t i = entries.size() - 1; i > 0 && entries[i - 1].sequence > entries[i].sequence; i--) {
+                std::swap(entries[i - 1], entries[i]);
+            }
+        }
+
+        // Capacity stays a power of two so indices wrap with a mask.
+        void GrowEvents() {
+            std::vector<Entry> grown(events.empty() ? 8 : events.size() * 2);
+            for (std::size_t i = 0; i < eventCount; i++) {
+                grown[i] = std::move(events[(eventStart + i) & (events.size() - 1)]);
+            }
+            events.swap(grown);
+            eventStart = 0;
+        }
+
+        StateSlot states[kUpdateTypeCount];
+        std::size_t pendingStates = 0;
+        std::vector<Entry> events;
+        std::size_t eventStart = 0;
+        std::size_t eventCount = 0;
+        std::uint64_t lastSequence = 0;
+        std::vector<Entry> drainStates;
+        std::vector<Entry> drainEvents;
+    };
+}
@@ -1,6 +1,7 @@
 #include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <vector>
 
 namespace GOTHIC_ENGINE {
 #ifndef SAFE_QUEUE
@@ -37,6 +38,17 @@ namespace GOTHIC_ENGINE {
             return val;
         }
 
+        // Moves everything queued to the end of out under a single lock.
+        void dequeueAll(std::vector<T>& out)
+        {
+            std::lock_guard<std::mutex> lock(m);
+            while (!q.empty())
+            {
+                out.push_back(q.front());
+                q.pop();
+            }
+        }
+
         bool isEmpty()
         {
             std::lock_guard<std::mutex> lock(m);
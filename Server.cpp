@@ -11,6 +11,12 @@ namespace GOTHIC_ENGINE {
             }
         } resetServerThread(&ServerThread);
 
+        struct CaptureExitClose {
+            ~CaptureExitClose() {
+                StopPacketCapture(CaptureRole::Host);
+            }
+        } closeCapture;
+
         CoopLog("[Server] Thread entry.");
         if (enet_initialize() != 0)
         {
@@ -24,7 +30,7 @@ namespace GOTHIC_ENGINE {
         ENetHost* server;
         enet_address_set_host(&address, "0.0.0.0");
         address.port = ConnectionPort;
-        server = enet_host_create(&address, 32, 2, 0, 0);
+        server = enet_host_create(&address, 32, kNetworkChannelCount, 0, 0);
         if (server == NULL)
         {
             CoopLog("[Server] ENet host create failed.");
@@ -33,12 +39,17 @@ namespace GOTHIC_ENGINE {
         }
 
         CoopLog("[Server] ENet host created.");
+        StartPacketCapture(CaptureRole::Host);
         ChatLog(string::Combine("(Server) Ready (v. %i, port %i).", COOP_VERSION, address.port));
         while (true) {
             try {
                 ENetEvent event;
                 auto eventStatus = enet_host_service(server, &event, 1);
+                FlushPacketCapture();
                 if (eventStatus > 0) {
+                    if (event.type == ENET_EVENT_TYPE_RECEIVE) {
+                        CapturePacket(CaptureDirection::Inbound, event.channelID, event.peer->incomingPeerID, event.packet->data, event.packet->dataLength);
+                    }
                     ReadyToBeReceivedPackets.enqueue(event);
                 }
 
@@ -54,16 +65,22 @@ namespace GOTHIC_ENGINE {
                             continue;
                         }
 
+                        if (networkPacket.recipientMask != 0 &&
+                            (player->friendIdNumber < 0 || player->friendIdNumber >= 64 || !(networkPacket.recipientMask & (1ull << player->friendIdNumber)))) {
+                            continue;
+                        }
+
                         if (playerId.empty() || !player->friendId.Compare(playerId.c_str())) {
                             std::vector<std::uint8_t> payload;
                             std::string error;
-                            if (!SerializeNetworkPacket(networkPacket, payload, error)) {
+                            ENetPacket* packet = CreateEnetPacket(networkPacket, payload, error);
+                            if (!packet) {
                                 ChatLog(string::Combine("Failed to serialize packet: %s", string(error.c_str())));
                                 continue;
                             }
 
-                            ENetPacket* packet = enet_packet_create(payload.data(), payload.size(), PacketFlag(networkPacket));
                             enet_peer_send(peer, PacketChannel(networkPacket), packet);
+                            CapturePacket(CaptureDirection::Outbound, PacketChannel(networkPacket), peer->incomingPeerID, payload.data(), payload.size());
                         }
                     }
                 }
@@ -72,13 +89,35 @@ namespace GOTHIC_ENGINE {
                     auto outboundPacket = ReadyToSendPackets.dequeue();
                     std::vector<std::uint8_t> payload;
                     std::string error;
-                    if (!SerializeNetworkPacket(outboundPacket, payload, error)) {
+                    ENetPacket* packet = CreateEnetPacket(outboundPacket, payload, error);
+                    if (!packet) {
                         ChatLog(string::Combine("Failed to serialize packet: %s", string(error.c_str())));
                         continue;
                     }
 
-                    ENetPacket* packet = enet_packet_create(payload.data(), payload.size(), PacketFlag(outboundPacket));
-                    enet_host_broadcast(server, PacketChannel(outboundPacket), packet);
+                    if (outboundPacket.recipientMask == 0) {
+                        enet_host_broadcast(server, PacketChannel(outboundPacket), packet);
+                        CapturePacket(CaptureDirection::Outbound, PacketChannel(outboundPacket), kCaptureBroadcastPeer, payload.data(), payload.size());
+                        continue;
+                    }
+
+                    for (size_t i = 0; i < server->peerCount; i++) {
+                        auto peer = &server->peers[i];
+                        auto player = (PeerData*)peer->data;
+
+                        if (!player || player->friendIdNumber < 0 || player->friendIdNumber >= 64) {
+                            continue;
+                        }
+
+                        if (outboundPacket.recipientMask & (1ull << player->friendIdNumber)) {
+                            enet_peer_send(peer, PacketChannel(outboundPacket), packet);
+                            CapturePacket(CaptureDirection::Outbound, PacketChannel(outboundPacket), peer->incomingPeerID, payload.data(), payload.size());
+                        }
+                    }
+
+                    if (packet->referenceCount == 0) {
+                        enet_packet_destroy(packet);
+                    }
                 }
             }
             catch (std::exception& ex) {
@@ -0,0 +1,194 @@
+namespace GOTHIC_ENGINE {
+    void ProcessCoopPacket(const NetworkPacket& packetData, ENetEvent packet);
+
+    static std::uint32_t SnapshotSequence = 0;
+    static long long LastSnapshotSentMs = 0;
+    static std::map<string, SnapshotEncoder> SnapshotEncoders;
+    static std::map<string, SnapshotDecoder> SnapshotDecoders;
+    // Host only: latest state reported by each client for its own player and
+    // the NPCs it owns, folded into the snapshots the host sends to everybody else.
+    static SnapshotWorld RelayedSnapshotStates;
+
+    static string GetSnapshotEntityOwner(const std::string& entityName) {
+        string name = entityName.c_str();
+        return IsCoopPlayer(name) ? name : GetNpcAuthority(name);
+    }
+
+    void ResetSnapshotPeer(string peerName) {
+        SnapshotEncoders.erase(peerName);
+        SnapshotDecoders.erase(peerName);
+        RelayedSnapshotStates.erase(peerName.ToChar());
+    }
+
+    // The next session's sequences start again from 0, so nothing from this
+    // one may be kept as a baseline.
+    void ClearSnapshotPeers() {
+        SnapshotEncoders.clear();
+        SnapshotDecoders.clear();
+        RelayedSnapshotStates.clear();
+    }
+
+    static void AddLocalSnapshotState(SnapshotWorld& world, LocalNpc* localNpc) {
+        EntitySnapshotState state;
+        if (localNpc && localNpc->GetSnapshotState(state)) {
+            world[localNpc->name.ToChar()] = state;
+        }
+    }
+
+    static void SendSnapshot(string peerName, const SnapshotWorld& world, std::uint64_t recipientMask) {
+        NetworkPacket packet;
+        packet.type = PacketType::StateSnapshot;
+        packet.senderId = ServerThread ? std::string("HOST") : std::string();
+        packet.recipientMask = recipientMask;
+        SnapshotEncoders[peerName].Encode(SnapshotSequence, world, packet.snapshot);
+
+        if (!packet.snapshot.entities.empty()) {
+            ReadyToSendPackets.enqueue(packet);
+        }
+    }
+
+    static void ApplySnapshotEntity(const EntitySnapshot& entity, ENetEvent event) {
+        static const UpdateType fieldUpdates[] = { SYNC_POS, SYNC_HEADING, SYNC_WEAPON_MODE, SYNC_HP, SYNC_PROTECTIONS, SYNC_TALENTS };
+        static const std::uint16_t fields[] = { SNAPSHOT_POS, SNAPSHOT_HEADING, SNAPSHOT_WEAPON_MODE, SNAPSHOT_HP, SNAPSHOT_PROTECTIONS, SNAPSHOT_TALENTS };
+
+        NetworkPacket update;
+        update.type = PacketType::PlayerStateUpdate;
+        update.senderId = entity.name;
+        update.stateUpdate.pos = entity.state.pos;
+        update.stateUpdate.heading = entity.state.heading;
+        update.stateUpdate.weaponMode = entity.state.weaponMode;
+        update.stateUpdate.hp = entity.state.hp;
+        update.stateUpdate.protections = entity.state.protections;
+        update.stateUpdate.talents = entity.state.talents;
+
+        // Only coop players carry protections and talents; applying them to an
+        // NPC would overwrite its values with zeros.
+        bool coopPlayer = IsCoopPlayer(entity.name);
+        for (int i = 0; i < 6; i++) {
+            if (!coopPlayer && (fieldUpdates[i] == SYNC_PROTECTIONS || fieldUpdates[i] == SYNC_TALENTS)) {
+                continue;
+            }
+            if (entity.fieldMask & fields[i]) {
+                update.stateUpdate.updateType = fieldUpdates[i];
+                ProcessCoopPacket(update, event);
+            }
+        }
+    }
+
+    void ProcessSnapshotPacket(const NetworkPacket& packetData, ENetEvent event) {
+        auto peerName = ServerThread ? string(packetData.senderId.c_str()) : string("HOST");
+
+        std::vector<EntitySnapshot> changed;
+        if (!SnapshotDecoders[peerName].Decode(packetData.snapshot, changed)) {
+            return;
+        }
+
+        NetworkPacket ack;
+        ack.type = PacketType::SnapshotAck;
+        ack.snapshotAck.sequence = packetData.snapshot.sequence;
+        if (ServerThread) {
+            auto peerData = (PeerData*)event.peer->data;
+            if (!peerData || peerData->friendIdNumber < 0 || peerData->friendIdNumber >= 64) {
+                return;
+            }
+            ack.senderId = "HOST";
+            ack.recipientMask = 1ull << peerData->friendIdNumber;
+        }
+        ReadyToSendPackets.enqueue(ack);
+
+        for (auto& entity : changed) {
+            auto name = string(entity.name.c_str());
+            if (name == MyselfId) {
+                continue;
+            }
+
+            if (ServerThread) {
+                // Clients only own their own player and the NPCs handed to them.
+                if (name != peerName && GetNpcAuthority(name) != peerName) {
+                    continue;
+                }
+                RelayedSnapshotStates[entity.name] = entity.state;
+            }
+
+            ApplySnapshotEntity(entity, event);
+        }
+    }
+
+    void ProcessSnapshotAck(const NetworkPacket& packetData) {
+        auto peerName = ServerThread ? string(packetData.senderId.c_str()) : string("HOST");
+        auto encoderIt = SnapshotEncoders.find(peerName);
+        if (encoderIt != SnapshotEncoders.end()) {
+            encoderIt->second.Acknowledge(packetData.snapshotAck.sequence);
+        }
+    }
+
+    void SnapshotProcessorLoop() {
+        PluginState = "SnapshotProcessorLoop";
+
+        if (!ServerThread && !ClientThread) {
+            if (!SnapshotEncoders.empty() || !SnapshotDecoders.empty()) {
+                ClearSnapshotPeers();
+            }
+            return;
+        }
+        if (IsCoopPaused) {
+            return;
+        }
+
+        // A host with snapshots off still relays the states of clients that
+        // send them, since the other peers get those fields from nowhere else.
+        bool relayOnly = !SnapshotReplication;
+        if (relayOnly && (!ServerThread || RelayedSnapshotStates.empty())) {
+            return;
+        }
+
+        if (CurrentMs < LastSnapshotSentMs + SnapshotIntervalMs) {
+            return;
+        }
+        LastSnapshotSentMs = CurrentMs;
+        SnapshotSequence++;
+
+        SnapshotWorld world;
+        if (!relayOnly) {
+            AddLocalSnapshotState(world, Myself);
+
+            for (auto& broadcastNpc : BroadcastNpcs) {
+                AddLocalSnapshotState(world, broadcastNpc.second);
+            }
+        }
+
+        if (ServerThread) {
+            for (auto it = RelayedSnapshotStates.begin(); it != RelayedSnapshotStates.end();) {
+                // NPCs the host took back are in BroadcastNpcs already.
+                if (GetSnapshotEntityOwner(it->first) == MyselfId) {
+                    it = RelayedSnapshotStates.erase(it);
+                    continue;
+                }
+                world[it->first] = it->second;
+                ++it;
+            }
+
+            for (auto friendIdNumber : ActiveFriendIds) {
+                if (friendIdNumber >= 64) {
+                    continue;
+                }
+                auto peerName = string::Combine("FRIEND_%i", friendIdNumber);
+                auto peerWorld = world;
+                for (auto it = peerWorld.begin(); it != peerWorld.end();) {
+                    auto owner = GetSnapshotEntityOwner(it->first);
+                    bool interested = IsCoopPlayer(it->first) || (GetInterestMask(it->first.c_str()) & (1ull << friendIdNumber));
+                    if (owner == peerName || !interested) {
+                        it = peerWorld.erase(it);
+                    }
+                    else {
+                        ++it;
+                    }
+                }
+                SendSnapshot(peerName, peerWorld, 1ull << friendIdNumber);
+            }
+        }
+        else {
+            SendSnapshot("HOST", world, 0);
+        }
+    }
+}
@@ -6,6 +6,12 @@
 #include "SafeQueue.cpp"
 #include "CustomTypes.cpp"
 #include "NetworkPackets.cpp"
+#include "NetTransport.cpp"
+#include "StateSnapshots.cpp"
+#include "PacketCapture.cpp"
+#include "InterpolationBuffer.cpp"
+#include "RemoteUpdateQueue.cpp"
+#include "SpatialGrid.cpp"
 #include "Chat.cpp"
 #include "Utils.cpp"
 #include "Global.cpp"
@@ -20,6 +26,9 @@
 #include "Server.cpp"
 #include "MappedPort.cpp"
 #include "GameStats.cpp"
+#include "NpcAuthority.cpp"
+#include "InterestSets.cpp"
+#include "SnapshotProcessor.cpp"
 #include "PacketProcessor.cpp"
 #include "DamageProcessor.cpp"
 #include "VisibleNpcsUpdater.cpp"
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace GOTHIC_ENGINE {
+    // Uniform grid over the ground plane (x, z) holding the last known position
+    // of each item. Radius queries only look at the cells the radius touches
+    // and test the candidates with squared distances, so their cost follows
+    // the number of items nearby rather than the number in the world.
+    // Positions are refreshed a few items at a time with Refresh.
+    template <typename T>
+    class SpatialGrid {
+    public:
+        explicit SpatialGrid(float cellSize) : cellSize(cellSize) {
+        }
+
+        // Inserts the item or moves it to its new position.
+        void Update(T item, float x, float y, float z) {
+            auto key = CellKey(x, z);
+            auto it = entries.find(item);
+            if (it == entries.end()) {
+                Entry entry;
+                entry.order = order.size();
+                order.push_back(item);
+                Place(item, entry, key, x, y, z);
+                entries[item] = entry;
+                return;
+            }
+
+            auto& entry = it->second;
+            if (entry.cell == key) {
+                auto& slot = cells[key][entry.slot];
+                slot.x = x;
+                slot.y = y;
+                slot.z = z;
+                return;
+            }
+            Unplace(entry);
+            Place(item, entry, key, x, y, z);
+        }
+
+        void Remove(T item) {
+            auto it = entries.find(item);
+            if (it == entries.end()) {
+                return;
+            }
+
+            Unplace(it->second);
+            auto index = it->second.order;
+            if (index + 1 != order.size()) {
+                order[index] = order.back();
+                entries[order[index]].order = index;
+            }
+            order.pop_back();
+            entries.erase(it);
+            if (refreshCursor > order.size()) {
+                refreshCursor = 0;
+            }
+        }
+
+        bool Contains(T item) const {
+            return entries.count(item) > 0;
+        }
+
+        std::size_t Size() const {
+            return order.size();
+        }
+
+        void Clear() {
+            cells.clear();
+            entries.clear();
+            order.clear();
+            refreshCursor = 0;
+        }
+
+        // Re-reads the position of up to count items, continuing where the
+        // previous call stopped. position(item, out) fills x, y, z and returns
+        // false when the item should leave the grid.
+        template <typename PositionFn>
+        void Refresh(std::size_t count, PositionFn&& position) {
+            for (std::size_t i = 0; i < count && !order.empty(); i++) {
+                if (refreshCursor >= order.size()) {
+                    refreshCursor = 0;
+                }
+                auto item = order[refreshCursor];
+                float pos[3];
+                if (!position(item, pos)) {
+                    Remove(item);
+                    continue;
+                }
+                Update(item, pos[0], pos[1], pos[2]);
+                refreshCursor++;
+            }
+        }
+
+        // Calls visit(item) for every item within radius of the point.
+        template <typename VisitFn>
+        void Query(float x, float y, float z, float radius, VisitFn&& visit) const {
+            float point[3] = { x, y, z };
+            QueryAny(&point, 1, radius, visit);
+        }
+
+        // Calls visit(item) once for every item within radius of any of the
+        // points, so several players are served by one pass over their cells.
+        template <typename VisitFn>
+        void QueryAny(const float (*points)[3], std::size_t pointCount, float radius, VisitFn&& visit) const {
+            queryCells.clear();
+            for (std::size_t p = 0; p < pointCount; p++) {
+                auto minX = CellCoord(points[p][0] - radius);
+                auto maxX = CellCoord(points[p][0] + radius);
+                auto minZ = CellCoord(points[p][2] - radius);
+                auto maxZ = CellCoord(points[p][2] + radius);
+                for (auto cx = minX; cx <= maxX; cx++) {
+                    for (auto cz = minZ; cz <= maxZ; cz++) {
+                        queryCells.push_back(PackCell(cx, cz));
+                    }
+                }
+            }
+            if (pointCount > 1) {
+                std::sort(queryCells.begin(), queryCells.end());
+                queryCells.erase(std::unique(queryCells.begin(), queryCells.end()), queryCells.end());
+            }
+
+            float radiusSquared = radius * radius;
+            for (auto key : queryCells) {
+                auto cell = cells.find(key);
+                if (cell == cells.end()) {
+                    continue;
+                }
+                for (auto& slot : cell->second) {
+                    for (std::size_t p = 0; p < pointCount; p++) {
+                        float dx = slot.x - points[p][0];
+                        float dy = slot.y - points[p][1];
+                        float dz = slot.z - points[p][2];
+                        if (dx * dx + dy * dy + dz * dz <= radiusSquared) {
+                            visit(slot.item);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+    private:
+        struct Slot {
+            T item;
+            float x;
+            float y;
+            float z;
+        };
+
+        struct Entry {
+            std::uint64_t cell = 0;
+            std::size_t slot = 0;
+            std::size_t order = 0;
+        };
+
+        std::int32_t CellCoord(float value) const {
+            return static_cast<std::int32_t>(std::floor(value / cellSize));
+        }
+
+        static std::uint64_t PackCell(std::int32_t cx, std::int32_t cz) {
+            return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32) | static_cast<std::uint32_t>(cz);
+        }
+
+        std::uint64_t CellKey(float x, float z) const {
+            return PackCell(CellCoord(x), CellCoord(z));
+        }
+
+        void Place(T item, Entry& entry, std::uint64_t key, float x, float y, float z) {
+            auto& cell = cells[key];
+            entry.cell = key;
+            entry.slot = cell.size();
+            cell.push_back({ item, x, y, z });
+        }
+
+        // Swap-removes the item from its cell, fixing up the slot of the item moved into its place.
+        void Unplace(const Entry& entry) {
+            auto cellIt = cells.find(entry.cell);
+            auto& cell = cellIt->second;
+            if (entry.slot + 1 != cell.size()) {
+                cell[entry.slot] = cell.back();
+                entries[cell[entry.slot].item].slot = entry.slot;
+            }
+            cell.pop_back();
+            if (cell.empty()) {
+                cells.erase(cellIt);
+            }
+        }
+
+        float cellSize;
+        std::unordered_map<std::uint64_t, std::vector<Slot>> cells;
+        std::unordered_map<T, Entry> entries;
+        std::vector<T> order;
+        std::size_t refreshCursor = 0;
+        mutable std::vector<std::uint64_t> queryCells;
+    };
+}
@@ -1,4 +1,37 @@
 namespace GOTHIC_ENGINE {
+    static std::vector<SpellCast> PendingSpellCasts;
+    static std::vector<oCNpc*> PendingSpellCastNpcs;
+
+    void ProcessSpellCast(SpellCast& spellCast) {
+        if (Myself && spellCast.npc == Myself->npc && NpcToUniqueNameList.count(spellCast.targetNpc)) {
+            spellCast.npcUniqueName = Myself->name;
+            spellCast.targetNpcUniqueName = NpcToUniqueNameList[spellCast.targetNpc];
+            Myself->spellCastsToSync.push_back(spellCast);
+            return;
+        }
+
+        auto uniqueNpcName = NpcToUniqueNameList.count(spellCast.npc) ? NpcToUniqueNameList[spellCast.npc] : NULL;
+
+        if (uniqueNpcName && BroadcastNpcs.count(uniqueNpcName)) {
+            spellCast.npcUniqueName = uniqueNpcName;
+
+            if (spellCast.targetNpc == player) {
+                spellCast.targetNpcUniqueName = MyselfId;
+                BroadcastNpcs[uniqueNpcName]->spellCastsToSync.push_back(spellCast);
+            }
+            else if (PlayerNpcs.count(spellCast.targetNpc)) {
+                spellCast.targetNpcUniqueName = PlayerNpcs[spellCast.targetNpc];
+                BroadcastNpcs[uniqueNpcName]->spellCastsToSync.push_back(spellCast);
+            }
+            else if (NpcToUniqueNameList.count(spellCast.targetNpc)) {
+                spellCast.targetNpcUniqueName = NpcToUniqueNameList[spellCast.targetNpc];
+                BroadcastNpcs[uniqueNpcName]->spellCastsToSync.push_back(spellCast);
+            }
+        }
+    }
+
+    // Handles every cast queued since the last frame. Casts land in the
+    // caster's spellCastsToSync and go out as one SYNC_SPELL_CAST on its next tick.
     void SpellCastProcessorLoop() {
         PluginState = "SpellCastProcessorLoop";
 
@@ -6,38 +39,22 @@ namespace GOTHIC_ENGINE {
             return;
         }
 
-        auto spellCast = ReadyToSyncSpellCasts.dequeue();
+        PendingSpellCasts.clear();
+        ReadyToSyncSpellCasts.dequeueAll(PendingSpellCasts);
 
         if (!ClientThread && !ServerThread) {
             return;
         }
 
-        if (Myself && spellCast.npc == Myself->npc && NpcToUniqueNameList.count(spellCast.targetNpc)) {
-            spellCast.npcUniqueName = Myself->name;
-            spellCast.targetNpcUniqueName = NpcToUniqueNameList[spellCast.targetNpc];
-            Myself->spellCastsToSync.push_back(spellCast);
-            return;
+        PendingSpellCastNpcs.clear();
+        for (auto& spellCast : PendingSpellCasts) {
+            PendingSpellCastNpcs.push_back(spellCast.npc);
+            PendingSpellCastNpcs.push_back(spellCast.targetNpc);
         }
+        EnsureNpcUniqueNames(PendingSpellCastNpcs);
 
-        if (ServerThread) {
-            auto uniqueNpcName = NpcToUniqueNameList.count(spellCast.npc) ? NpcToUniqueNameList[spellCast.npc] : NULL;
-
-            if (uniqueNpcName && BroadcastNpcs.count(uniqueNpcName)) {
-                spellCast.npcUniqueName = uniqueNpcName;
-
-                if (spellCast.targetNpc == player) {
-                    spellCast.targetNpcUniqueName = "HOST";
-                    BroadcastNpcs[uniqueNpcName]->spellCastsToSync.push_back(spellCast);
-                }
-                else if (PlayerNpcs.count(spellCast.targetNpc)) {
-                    spellCast.targetNpcUniqueName = PlayerNpcs[spellCast.targetNpc];
-                    BroadcastNpcs[uniqueNpcName]->spellCastsToSync.push_back(spellCast);
-                }
-                else if (NpcToUniqueNameList.count(spellCast.targetNpc)) {
-                    spellCast.targetNpcUniqueName = NpcToUniqueNameList[spellCast.targetNpc];
-                    BroadcastNpcs[uniqueNpcName]->spellCastsToSync.push_back(spellCast);
-                }
-            }
+        for (auto& spellCast : PendingSpellCasts) {
+            ProcessSpellCast(spellCast);
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace GOTHIC_ENGINE {
+    bool IsSnapshotReplicatedUpdate(int type) {
+        switch (type) {
+        case SYNC_POS:
+        case SYNC_HEADING:
+        case SYNC_WEAPON_MODE:
+        case SYNC_HP:
+        case SYNC_PROTECTIONS:
+        case SYNC_TALENTS:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    std::uint16_t GetSnapshotAllowedFields(const std::string& entityName) {
+        bool coopPlayer = entityName == "HOST" || entityName.compare(0, 7, "FRIEND_") == 0;
+        return coopPlayer ? kSnapshotAllFields : kSnapshotNpcFields;
+    }
+
+    std::uint16_t DiffSnapshotState(const EntitySnapshotState& from, const EntitySnapshotState& to) {
+        std::uint16_t mask = 0;
+        if (from.pos.x != to.pos.x || from.pos.y != to.pos.y || from.pos.z != to.pos.z
+            || from.pos.vx != to.pos.vx || from.pos.vy != to.pos.vy || from.pos.vz != to.pos.vz) {
+            mask |= SNAPSHOT_POS;
+        }
+        if (from.heading.heading != to.heading.heading) {
+            mask |= SNAPSHOT_HEADING;
+        }
+        if (from.weaponMode.weaponMode != to.weaponMode.weaponMode) {
+            mask |= SNAPSHOT_WEAPON_MODE;
+        }
+        if (from.hp.hp != to.hp.hp || from.hp.hpMax != to.hp.hpMax) {
+            mask |= SNAPSHOT_HP;
+        }
+        for (int i = 0; i < 8; ++i) {
+            if (from.protections.protections[i] != to.protections.protections[i]) {
+                mask |= SNAPSHOT_PROTECTIONS;
+                break;
+            }
+        }
+        for (int i = 0; i < 4; ++i) {
+            if (from.talents.talents[i] != to.talents.talents[i]) {
+                mask |= SNAPSHOT_TALENTS;
+                break;
+            }
+        }
+        return mask;
+    }
+
+    void ApplySnapshotFields(EntitySnapshotState& target, const EntitySnapshotState& source, std::uint16_t mask) {
+        if (mask & SNAPSHOT_POS) target.pos = source.pos;
+        if (mask & SNAPSHOT_HEADING) target.heading = source.heading;
+        if (mask & SNAPSHOT_WEAPON_MODE) target.weaponMode = source.weaponMode;
+        if (mask & SNAPSHOT_HP) target.hp = source.hp;
+        if (mask & SNAPSHOT_PROTECTIONS) target.protections = source.protections;
+        if (mask & SNAPSHOT_TALENTS) target.talents = source.talents;
+    }
+
+    void SnapshotHistory::Store(std::uint32_t sequence, SnapshotWorld world) {
+        auto& entry = entries[sequence % kSnapshotHistorySize];
+        entry.sequence = sequence;
+        entry.world = std::move(world);
+    }
+
+    const SnapshotWorld* SnapshotHistory::Find(std::uint32_t sequence) const {
+        if (sequence == 0) {
+            return nullptr;
+        }
+        auto& entry = entries[sequence % kSnapshotHistorySize];
+        return entry.sequence == sequence ? &entry.world : nullptr;
+    }
+
+    void SnapshotHistory::Clear() {
+        for (auto& entry : entries) {
+            entry.sequence = 0;
+            entry.world.clear();
+        }
+    }
+
+    void SnapshotEncoder::Encode(std::uint32_t sequence, const SnapshotWorld& world, StateSnapshotPacket& out) {
+        static const SnapshotWorld emptyWorld;
+
+        out.sequence = sequence;
+        out.baselineSequence = 0;
+        out.entities.clear();
+
+        const SnapshotWorld* baseline = &emptyWorld;
+        if (ackedSequence != 0 && sequence - ackedSequence <= kSnapshotMaxBaselineAge) {
+            if (auto ackedWorld = history.Find(ackedSequence)) {
+                baseline = ackedWorld;
+                out.baselineSequence = ackedSequence;
+            }
+        }
+
+        SnapshotWorld reconstructed = *baseline;
+        std::size_t budget = kSnapshotPacketBudget;
+
+        // Rotate the starting entity so a world that does not fit one packet
+        // does not starve the same names every time.
+        auto start = world.begin();
+        if (!world.empty()) {
+            std::advance(start, sequence % world.size());
+        }
+        auto it = start;
+        for (std::size_t visited = 0; visited < world.size(); ++visited) {
+            if (it == world.end()) {
+                it = world.begin();
+            }
+
+            auto baselineIt = baseline->find(it->first);
+            std::uint16_t mask = baselineIt == baseline->end()
+                ? kSnapshotAllFields
+                : DiffSnapshotState(baselineIt->second, it->second);
+            mask &= GetSnapshotAllowedFields(it->first);
+            if (mask != 0 && out.entities.size() < kMaxSnapshotEntities) {
+                EntitySnapshot entity;
+                entity.name = it->first;
+                entity.fieldMask = mask;
+                entity.state = it->second;
+
+                auto size = SnapshotEntityWireSize(entity);
+                if (size <= budget) {
+                    budget -= size;
+                    reconstructed[it->first] = it->second;
+                    out.entities.push_back(std::move(entity));
+                }
+            }
+            ++it;
+        }
+
+        history.Store(sequence, std::move(reconstructed));
+    }
+
+    void SnapshotEncoder::Acknowledge(std::uint32_t sequence) {
+        if (sequence > ackedSequence && history.Find(sequence)) {
+            ackedSequence = sequence;
+        }
+    }
+
+    std::uint32_t SnapshotEncoder::AckedSequence() const {
+        return ackedSequence;
+    }
+
+    bool SnapshotDecoder::Decode(const StateSnapshotPacket& packet, std::vector<EntitySnapshot>& changed) {
+        static const SnapshotWorld emptyWorld;
+
+        changed.clear();
+        if (latestSequence > kSnapshotHistorySize && packet.sequence <= latestSequence - kSnapshotHistorySize) {
+            return false;
+        }
+
+        const SnapshotWorld* baseline = &emptyWorld;
+        if (packet.baselineSequence != 0) {
+            baseline = history.Find(packet.baselineSequence);
+            if (!baseline) {
+                return false;
+            }
+        }
+
+        SnapshotWorld world = *baseline;
+        for (const auto& entity : packet.entities) {
+            ApplySnapshotFields(world[entity.name], entity.state, entity.fieldMask & GetSnapshotAllowedFields(entity.name));
+        }
+
+        if (packet.sequence > latestSequence) {
+            latestSequence = packet.sequence;
+            for (const auto& entry : world) {
+                auto appliedIt = applied.find(entry.first);
+                std::uint16_t mask = appliedIt == applied.end()
+                    ? kSnapshotAllFields
+                    : DiffSnapshotState(appliedIt->second, entry.second);
+                mask &= GetSnapshotAllowedFields(entry.first);
+                if (mask == 0) {
+                    continue;
+                }
+
+                EntitySnapshot entity;
+                entity.name = entry.first;
+                entity.fieldMask = mask;
+                entity.state = entry.second;
+                changed.push_back(std::move(entity));
+                applied[entry.first] = entry.second;
+            }
+        }
+
+        history.Store(packet.sequence, std::move(world));
+        return true;
+    }
+
+    std::uint32_t SnapshotDecoder::LatestSequence() const {
+        return latestSequence;
+    }
+}
@@ -0,0 +1,63 @@
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace GOTHIC_ENGINE {
+    constexpr std::uint32_t kSnapshotHistorySize = 32;
+    // Baselines older than this are not used for deltas, so the receiver is
+    // guaranteed to still have them in its own history.
+    constexpr std::uint32_t kSnapshotMaxBaselineAge = kSnapshotHistorySize / 2;
+    constexpr std::size_t kSnapshotPacketBudget = kMaxPacketBytes - 64;
+
+    typedef std::map<std::string, EntitySnapshotState> SnapshotWorld;
+
+    bool IsSnapshotReplicatedUpdate(int type);
+    std::uint16_t GetSnapshotAllowedFields(const std::string& entityName);
+    std::uint16_t DiffSnapshotState(const EntitySnapshotState& from, const EntitySnapshotState& to);
+    void ApplySnapshotFields(EntitySnapshotState& target, const EntitySnapshotState& source, std::uint16_t mask);
+
+    class SnapshotHistory {
+    public:
+        void Store(std::uint32_t sequence, SnapshotWorld world);
+        const SnapshotWorld* Find(std::uint32_t sequence) const;
+        void Clear();
+
+    private:
+        struct Entry {
+            std::uint32_t sequence = 0;
+            SnapshotWorld world;
+        };
+        Entry entries[kSnapshotHistorySize];
+    };
+
+    // Sender side, one per receiving peer. The history holds what the receiver
+    // will have reconstructed for each sequence, so entities left out of a full
+    // packet are simply diffed again next time.
+    class SnapshotEncoder {
+    public:
+        void Encode(std::uint32_t sequence, const SnapshotWorld& world, StateSnapshotPacket& out);
+        void Acknowledge(std::uint32_t sequence);
+        std::uint32_t AckedSequence() const;
+
+    private:
+        SnapshotHistory history;
+        std::uint32_t ackedSequence = 0;
+    };
+
+    // Receiver side, one per sending peer.
+    class SnapshotDecoder {
+    public:
+        // Reconstructs the sender's state for the packet and returns every entity
+        // that differs from what was last applied, with the differing fields in
+        // fieldMask. Snapshots older than the newest one are kept as baselines
+        // only. Returns false when the packet cannot be decoded and must not be acked.
+        bool Decode(const StateSnapshotPacket& packet, std::vector<EntitySnapshot>& changed);
+        std::uint32_t LatestSequence() const;
+
+    private:
+        SnapshotHistory history;
+        SnapshotWorld applied;
+        std::uint32_t latestSequence = 0;
+    };
+}
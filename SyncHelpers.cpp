@@ -16,6 +16,6 @@ namespace GOTHIC_ENGINE {
 		}
 		PlayerStateUpdatePacket update;
 		update.updateType = DESTROY_NPC;
-		removedNpc->localUpdates.push_back(update);
+		removedNpc->localUpdates.Push(update);
 	}
 }
\ No newline at end of file
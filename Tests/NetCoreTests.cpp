@@ -0,0 +1,571 @@
+// Headless checks for the packet codec in netcore: every update type survives
+// an encode/decode round trip, damaged or oversized packets are rejected,
+// snapshot deltas rebuild the sender's state and server-side text
+// sanitization handles its edge cases.
+// Usage: netcore_tests (exit code 0 when every check passes)
+#include "NetCore/NetCore.h"
+
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace NetCore;
+
+namespace {
+    int Failures = 0;
+    int Checks = 0;
+
+#define CHECK(condition) Check((condition), #condition, __FILE__, __LINE__)
+
+    void Check(bool condition, const char* expression, const char* file, int line) {
+        Checks++;
+        if (!condition) {
+            Failures++;
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        }
+    }
+
+    NetworkPacket StateUpdate(UpdateType type, const char* sender = "WOLF-NW_FOREST_PATH_35_01-7") {
+        NetworkPacket packet;
+        packet.type = PacketType::PlayerStateUpdate;
+        packet.senderId = sender;
+        packet.stateUpdate.updateType = type;
+        return packet;
+    }
+
+    // A packet with every field of the update type set to a non-default value.
+    // Returns false for update types that are not sent as state updates.
+    bool MakeUpdate(UpdateType type, NetworkPacket& packet) {
+        packet = StateUpdate(type);
+        auto& update = packet.stateUpdate;
+        switch (type) {
+        case SYNC_POS:
+            update.pos = { 1200.5f, -340.25f, 8800.0f, 120.0f, -4.5f, 300.0f };
+            return true;
+        case SYNC_HEADING:
+            update.heading.heading = 271.5f;
+            return true;
+        case SYNC_ANIMATION:
+            update.animation.sequence = 1042;
+            update.animation.entries = { { 408, 90110 }, { 411, 90420 } };
+            return true;
+        case SYNC_WEAPON_MODE:
+            update.weaponMode.weaponMode = 3;
+            return true;
+        case INIT_NPC:
+            update.initNpc.instanceId = 11471;
+            update.initNpc.nickname = "Diego";
+            update.initNpc.x = 10.0f;
+            update.initNpc.y = 20.0f;
+            update.initNpc.z = 30.0f;
+            update.initNpc.bodyModel = "HUM_BODY_NAKED0";
+            update.initNpc.BodyTex = 9;
+            update.initNpc.BodyColor = 1;
+            update.initNpc.headModel = "HUM_HEAD_PONY";
+            update.initNpc.HeadTex = 18;
+            return true;
+        case DESTROY_NPC:
+        case RELEASE_NPC:
+            return true;
+        case SYNC_ATTACKS:
+            for (int i = 0; i < 3; i++) {
+                AttackInfo attack;
+                attack.target = "SHEEP-NW_FARM1_OUT_01-" + std::to_string(i);
+                attack.damage = 42.0f + i;
+                attack.isUnconscious = i == 1;
+                attack.isDead = i == 2;
+                attack.isFinish = i == 0;
+                attack.damageMode = 2;
+                update.attacks.attacks.push_back(attack);
+            }
+            return true;
+        case SYNC_ARMOR:
+            update.armor.armor = "ITAR_MIL_L";
+            return true;
+        case SYNC_WEAPONS:
+            update.weapons.weapon1 = "ITMW_1H_MIL_SWORD";
+            update.weapons.weapon2 = "ITRW_BOW_L_02";
+            return true;
+        case SYNC_HP:
+            update.hp.hp = 80;
+            update.hp.hpMax = 120;
+            return true;
+        case SYNC_TIME:
+            update.time.rawTime = 123456.0f;
+            return true;
+        case SYNC_HAND:
+            update.hand.leftItem = "NULL";
+            update.hand.rightItem = "ITFO_APPLE";
+            return true;
+        case SYNC_MAGIC_SETUP:
+            update.magicSetup.spellInstanceName = "ITRU_FIREBOLT";
+            return true;
+        case SYNC_SPELL_CAST:
+        {
+            SpellCastInfo cast;
+            cast.target = "WOLF-NW_FOREST_PATH_35_01-7";
+            cast.spellInstanceId = 9001;
+            cast.spellLevel = 1;
+            cast.spellCharge = 2;
+            update.spellCasts.casts.push_back(cast);
+            return true;
+        }
+        case SYNC_REVIVED:
+            update.revived.name = "FRIEND_2";
+            return true;
+        case SYNC_PROTECTIONS:
+            for (int i = 0; i < 8; i++) {
+                update.protections.protections[i] = 10 * i;
+            }
+            return true;
+        case SYNC_TALENTS:
+            for (int i = 0; i < 4; i++) {
+                update.talents.talents[i] = i;
+            }
+            return true;
+        case SYNC_BODYSTATE:
+            update.bodyState.bodyState = 17;
+            return true;
+        case SYNC_OVERLAYS:
+            update.overlays.overlays = { 12, 1, 40 };
+            return true;
+        case SYNC_DROPITEM:
+            update.dropItem.itemDropped = "ITMI_GOLD";
+            update.dropItem.itemUniqueName = "ITMI_GOLD-1700000000";
+            update.dropItem.count = 25;
+            update.dropItem.flags = 4;
+            return true;
+        case SYNC_TAKEITEM:
+            update.takeItem.itemDropped = "ITMI_GOLD";
+            update.takeItem.uniqueName = "ITMI_GOLD-1700000000";
+            update.takeItem.count = 25;
+            update.takeItem.flags = 4;
+            update.takeItem.x = -500.0f;
+            update.takeItem.y = 75.0f;
+            update.takeItem.z = 1250.0f;
+            return true;
+        case SYNC_PLAYER_NAME:
+        case PLAYER_DISCONNECT:
+            return false;
+        }
+        return false;
+    }
+
+    std::vector<NetworkPacket> OtherPackets() {
+        std::vector<NetworkPacket> packets;
+
+        NetworkPacket join;
+        join.type = PacketType::JoinGame;
+        join.senderId = "HOST";
+        join.joinGame.connectId = 12345;
+        join.joinGame.name = "FRIEND_1";
+        packets.push_back(join);
+
+        NetworkPacket disconnect;
+        disconnect.type = PacketType::PlayerDisconnect;
+        disconnect.senderId = "HOST";
+        disconnect.disconnect.name = "FRIEND_1";
+        disconnect.disconnect.hasNickname = true;
+        disconnect.disconnect.nickname = "Diego";
+        packets.push_back(disconnect);
+
+        NetworkPacket snapshot;
+        snapshot.type = PacketType::StateSnapshot;
+        snapshot.senderId = "HOST";
+        snapshot.snapshot.sequence = 10;
+        snapshot.snapshot.baselineSequence = 8;
+        for (int i = 0; i < 3; i++) {
+            EntitySnapshot entity;
+            entity.name = "WOLF-NW_FOREST_PATH_35_01-" + std::to_string(i);
+            entity.fieldMask = i == 0 ? kSnapshotAllFields : static_cast<std::uint16_t>(SNAPSHOT_POS | SNAPSHOT_HP);
+            entity.state.pos.x = 100.0f * i;
+            entity.state.hp.hp = 50;
+            entity.state.hp.hpMax = 60;
+            snapshot.snapshot.entities.push_back(entity);
+        }
+        packets.push_back(snapshot);
+
+        NetworkPacket ack;
+        ack.type = PacketType::SnapshotAck;
+        ack.snapshotAck.sequence = 10;
+        packets.push_back(ack);
+
+        NetworkPacket authority;
+        authority.type = PacketType::NpcAuthority;
+        authority.senderId = "HOST";
+        NpcAuthorityEntry entry;
+        entry.npc = "WOLF-NW_FOREST_PATH_35_01-7";
+        entry.owner = "FRIEND_1";
+        authority.authority.entries.push_back(entry);
+        packets.push_back(authority);
+
+        return packets;
+    }
+
+    std::vector<NetworkPacket> AllPackets() {
+        std::vector<NetworkPacket> packets;
+        for (int type = 0; type <= static_cast<int>(RELEASE_NPC); type++) {
+            NetworkPacket packet;
+            if (MakeUpdate(static_cast<UpdateType>(type), packet)) {
+                packets.push_back(packet);
+            }
+        }
+        for (auto& packet : OtherPackets()) {
+            packets.push_back(packet);
+        }
+        return packets;
+    }
+
+    bool Encode(const NetworkPacket& packet, std::vector<std::uint8_t>& bytes) {
+        std::string error;
+        return SerializeNetworkPacket(packet, bytes, error);
+    }
+
+    bool Decode(const std::vector<std::uint8_t>& bytes, NetworkPacket& packet, PacketDecodeMode mode = PacketDecodeMode::Client) {
+        std::string error;
+        return DeserializeNetworkPacket(bytes.data(), bytes.size(), packet, error, mode);
+    }
+
+    // Encoding the decoded packet again must give the same bytes, so every
+    // serialized field survived the trip.
+    void TestRoundTrips() {
+        for (const auto& packet : AllPackets()) {
+            std::vector<std::uint8_t> bytes;
+            CHECK(Encode(packet, bytes));
+
+            NetworkPacket decoded;
+            CHECK(Decode(bytes, decoded));
+            CHECK(decoded.type == packet.type);
+            CHECK(decoded.senderId == packet.senderId);
+
+            std::vector<std::uint8_t> again;
+            CHECK(Encode(decoded, again));
+            CHECK(again == bytes);
+            if (again != bytes) {
+                std::fprintf(stderr, "  round trip differs for %s\n", DescribePacket(packet).c_str());
+            }
+        }
+
+        NetworkPacket overlays;
+        MakeUpdate(SYNC_OVERLAYS, overlays);
+        std::vector<std::uint8_t> bytes;
+        NetworkPacket decoded;
+        CHECK(Encode(overlays, bytes) && Decode(bytes, decoded));
+        CHECK(decoded.stateUpdate.overlays.overlays == overlays.stateUpdate.overlays.overlays);
+
+        NetworkPacket attacks;
+        MakeUpdate(SYNC_ATTACKS, attacks);
+        CHECK(Encode(attacks, bytes) && Decode(bytes, decoded));
+        CHECK(decoded.stateUpdate.attacks.attacks.size() == 3);
+        CHECK(decoded.stateUpdate.attacks.attacks[2].target == "SHEEP-NW_FARM1_OUT_01-2");
+        CHECK(decoded.stateUpdate.attacks.attacks[2].isDead);
+    }
+
+    void TestNotSentAsStateUpdates() {
+        std::vector<std::uint8_t> bytes;
+        CHECK(!Encode(StateUpdate(SYNC_PLAYER_NAME), bytes));
+        CHECK(!Encode(StateUpdate(PLAYER_DISCONNECT), bytes));
+    }
+
+    void TestTruncatedPackets() {
+        for (const auto& packet : AllPackets()) {
+            std::vector<std::uint8_t> bytes;
+            CHECK(Encode(packet, bytes));
+            for (std::size_t size = 0; size < bytes.size(); size++) {
+                std::vector<std::uint8_t> prefix(bytes.begin(), bytes.begin() + size);
+                NetworkPacket decoded;
+                bool accepted = Decode(prefix, decoded);
+                CHECK(!accepted);
+                if (accepted) {
+                    std::fprintf(stderr, "  %zu of %zu bytes accepted for %s\n", size, bytes.size(), DescribePacket(packet).c_str());
+                }
+            }
+        }
+    }
+
+    void TestOversizedPackets() {
+        std::vector<std::uint8_t> bytes;
+        NetworkPacket decoded;
+
+        std::vector<std::uint8_t> huge(kMaxPacketBytes + 1, 0);
+        huge[0] = kNetworkPacketVersion;
+        CHECK(!Decode(huge, decoded));
+
+        auto longSender = StateUpdate(DESTROY_NPC, "");
+        longSender.senderId.assign(kMaxNameLength + 1, 'A');
+        CHECK(!Encode(longSender, bytes));
+
+        NetworkPacket armor;
+        MakeUpdate(SYNC_ARMOR, armor);
+        armor.stateUpdate.armor.armor.assign(kMaxInstanceNameLength + 1, 'A');
+        CHECK(!Encode(armor, bytes));
+
+        NetworkPacket attacks = StateUpdate(SYNC_ATTACKS);
+        attacks.stateUpdate.attacks.attacks.resize(kMaxAttackCount + 1);
+        CHECK(!Encode(attacks, bytes));
+
+        NetworkPacket overlays = StateUpdate(SYNC_OVERLAYS);
+        overlays.stateUpdate.overlays.overlays.assign(kMaxOverlayCount + 1, 1);
+        CHECK(!Encode(overlays, bytes));
+
+        // Overlay ids index the known overlay table, anything past it is rejected.
+        overlays.stateUpdate.overlays.overlays = { 3, 5 };
+        CHECK(Encode(overlays, bytes));
+        bytes.back() = static_cast<std::uint8_t>(kMaxOverlayCount);
+        CHECK(!Decode(bytes, decoded));
+
+        // A length prefix past the limit is rejected even when the bytes are there.
+        NetworkPacket magic;
+        MakeUpdate(SYNC_MAGIC_SETUP, magic);
+        magic.senderId.clear();
+        CHECK(Encode(magic, bytes));
+        std::size_t lengthOffset = 4;
+        bytes[lengthOffset] = static_cast<std::uint8_t>(kMaxInstanceNameLength + 1);
+        bytes[lengthOffset + 1] = 0;
+        bytes.resize(lengthOffset + 2 + kMaxInstanceNameLength + 1, 'A');
+        CHECK(!Decode(bytes, decoded));
+    }
+
+    void TestInvalidHeaders() {
+        NetworkPacket packet;
+        MakeUpdate(SYNC_HP, packet);
+        std::vector<std::uint8_t> bytes;
+        NetworkPacket decoded;
+        CHECK(Encode(packet, bytes));
+
+        auto wrongVersion = bytes;
+        wrongVersion[0] = static_cast<std::uint8_t>(kNetworkPacketVersion + 1);
+        CHECK(!Decode(wrongVersion, decoded));
+
+        auto unknownType = bytes;
+        unknownType[1] = 200;
+        CHECK(!Decode(unknownType, decoded));
+
+        auto unknownUpdate = StateUpdate(DESTROY_NPC, "");
+        CHECK(Encode(unknownUpdate, bytes));
+        bytes[3] = 200;
+        CHECK(!Decode(bytes, decoded));
+
+        // Only state updates may name a sender when they come from a client.
+        NetworkPacket join = OtherPackets()[0];
+        CHECK(Encode(join, bytes));
+        CHECK(Decode(bytes, decoded, PacketDecodeMode::Client));
+        CHECK(!Decode(bytes, decoded, PacketDecodeMode::Server));
+
+        NetworkPacket position;
+        MakeUpdate(SYNC_POS, position);
+        position.stateUpdate.pos.x = std::numeric_limits<float>::quiet_NaN();
+        CHECK(Encode(position, bytes));
+        CHECK(!Decode(bytes, decoded));
+    }
+
+    EntitySnapshotState SnapshotState(float x, int hp) {
+        EntitySnapshotState state;
+        state.pos = { x, 100.0f, -2500.0f, 0.0f, 0.0f, 0.0f };
+        state.heading.heading = 90.0f;
+        state.weaponMode.weaponMode = 1;
+        state.hp = { hp, 400 };
+        for (int i = 0; i < 8; i++) {
+            state.protections.protections[i] = 10 + i;
+        }
+        for (int i = 0; i < 4; i++) {
+            state.talents.talents[i] = 30 + i;
+        }
+        return state;
+    }
+
+    SnapshotWorld SnapshotTestWorld() {
+        SnapshotWorld world;
+        world["FRIEND_1"] = SnapshotState(1000.0f, 400);
+        world["SHEEP-NW_FARM1_OUT_01-2"] = SnapshotState(-800.0f, 120);
+        world["WOLF-NW_FOREST_PATH_35_01-7"] = SnapshotState(3200.0f, 250);
+        return world;
+    }
+
+    // Snapshots go through the wire format, as they would between peers.
+    StateSnapshotPacket EncodeSnapshot(SnapshotEncoder& encoder, std::uint32_t sequence, const SnapshotWorld& world) {
+        NetworkPacket packet;
+        packet.type = PacketType::StateSnapshot;
+        encoder.Encode(sequence, world, packet.snapshot);
+
+        std::vector<std::uint8_t> bytes;
+        NetworkPacket decoded;
+        CHECK(Encode(packet, bytes) && Decode(bytes, decoded));
+        return decoded.snapshot;
+    }
+
+    const EntitySnapshot* FindEntity(const std::vector<EntitySnapshot>& entities, const char* name) {
+        for (auto& entity : entities) {
+            if (entity.name == name) {
+                return &entity;
+            }
+        }
+        return nullptr;
+    }
+
+    void TestSnapshotDeltas() {
+        SnapshotEncoder encoder;
+        SnapshotDecoder decoder;
+        std::vector<EntitySnapshot> changed;
+        auto world = SnapshotTestWorld();
+
+        auto full = EncodeSnapshot(encoder, 1, world);
+        CHECK(full.baselineSequence == 0);
+        CHECK(full.entities.size() == 3);
+        CHECK(decoder.Decode(full, changed));
+        CHECK(changed.size() == 3);
+
+        // Only players carry protections and talents.
+        auto player = FindEntity(changed, "FRIEND_1");
+        auto npc = FindEntity(changed, "SHEEP-NW_FARM1_OUT_01-2");
+        CHECK(player && player->fieldMask == kSnapshotAllFields);
+        CHECK(player && player->state.talents.talents[3] == 33);
+        CHECK(npc && npc->fieldMask == kSnapshotNpcFields);
+
+        // A delta against the acked baseline carries only what changed.
+        encoder.Acknowledge(1);
+        world["SHEEP-NW_FARM1_OUT_01-2"].hp.hp = 60;
+        auto delta = EncodeSnapshot(encoder, 2, world);
+        CHECK(delta.baselineSequence == 1);
+        CHECK(delta.entities.size() == 1);
+        CHECK(delta.entities.size() == 1 && delta.entities[0].fieldMask == SNAPSHOT_HP);
+        CHECK(decoder.Decode(delta, changed));
+        CHECK(changed.size() == 1 && changed[0].state.hp.hp == 60);
+
+        // Changes to an NPC's protections are never sent.
+        encoder.Acknowledge(2);
+        world["WOLF-NW_FOREST_PATH_35_01-7"].protections.protections[0] = 0;
+        CHECK(EncodeSnapshot(encoder, 3, world).entities.empty());
+
+        // A lost snapshot: the next one is still diffed against the acked
+        // baseline, so it carries both changes.
+        world["FRIEND_1"].pos.x = 1100.0f;
+        EncodeSnapshot(encoder, 4, world);
+        world["WOLF-NW_FOREST_PATH_35_01-7"].heading.heading = 180.0f;
+        auto afterLoss = EncodeSnapshot(encoder, 5, world);
+        CHECK(afterLoss.baselineSequence == 2);
+        CHECK(decoder.Decode(afterLoss, changed));
+        CHECK(changed.size() == 2);
+        auto moved = FindEntity(changed, "FRIEND_1");
+        auto turned = FindEntity(changed, "WOLF-NW_FOREST_PATH_35_01-7");
+        CHECK(moved && moved->fieldMask == SNAPSHOT_POS && moved->state.pos.x == 1100.0f);
+        CHECK(turned && turned->fieldMask == SNAPSHOT_HEADING);
+
+        // An ack for a snapshot the encoder never sent is ignored.
+        encoder.Acknowledge(40);
+        CHECK(encoder.AckedSequence() == 2);
+
+        // A baseline older than the age cap falls back to a full snapshot, and
+        // the decoder reports only what differs from what it applied.
+        encoder.Acknowledge(5);
+        std::uint32_t sequence = 5 + kSnapshotMaxBaselineAge + 1;
+        world["SHEEP-NW_FARM1_OUT_01-2"].hp.hp = 0;
+        auto stale = EncodeSnapshot(encoder, sequence, world);
+        CHECK(stale.baselineSequence == 0);
+        CHECK(stale.entities.size() == 3);
+        CHECK(decoder.Decode(stale, changed));
+        CHECK(changed.size() == 1 && changed[0].fieldMask == SNAPSHOT_HP && changed[0].state.hp.hp == 0);
+
+        // Deltas against a baseline the decoder does not have are not acked.
+        StateSnapshotPacket unknown;
+        unknown.sequence = sequence + 1;
+        unknown.baselineSequence = 3;
+        CHECK(!decoder.Decode(unknown, changed));
+    }
+
+    void TestSnapshotSequences() {
+        SnapshotEncoder encoder;
+        SnapshotDecoder decoder;
+        std::vector<EntitySnapshot> changed;
+        auto world = SnapshotTestWorld();
+
+        for (std::uint32_t sequence = 1; sequence <= 100; sequence++) {
+            world["FRIEND_1"].pos.x = static_cast<float>(sequence);
+            CHECK(decoder.Decode(EncodeSnapshot(encoder, sequence, world), changed));
+            encoder.Acknowledge(sequence);
+        }
+        CHECK(decoder.LatestSequence() == 100);
+
+        // An older snapshot inside the history is kept as a baseline only.
+        SnapshotEncoder late;
+        world["FRIEND_1"].pos.x = 80.0f;
+        auto older = EncodeSnapshot(late, 80, world);
+        CHECK(decoder.Decode(older, changed));
+        CHECK(changed.empty());
+
+        // A restarted sender counts from 0 again. Its snapshots fall behind the
+        // decoder's history and are rejected until the peer is reset.
+        SnapshotEncoder restarted;
+        auto first = EncodeSnapshot(restarted, 1, world);
+        CHECK(!decoder.Decode(first, changed));
+
+        SnapshotDecoder reset;
+        CHECK(reset.Decode(first, changed));
+        CHECK(changed.size() == 3);
+    }
+
+    void TestSanitize() {
+        std::string text;
+
+        text = "";
+        CHECK(SanitizeServerText(text, 16) && text.empty());
+
+        text = "FRIEND_1";
+        CHECK(SanitizeServerText(text, 16) && text == "FRIEND_1");
+
+        text = "0123456789ABCDEFGH";
+        CHECK(SanitizeServerText(text, 16) && text == "0123456789ABCDEF");
+
+        text = "Die\x07go\x7F";
+        CHECK(SanitizeServerText(text, 16) && text == "Diego");
+
+        text = "\x01\x02\x1F\x7F";
+        CHECK(!SanitizeServerText(text, 16));
+
+        // Unprintable bytes are stripped before the length cap applies.
+        text = "\x01" "ABCDEFGHIJKLMNOP";
+        CHECK(SanitizeServerText(text, 16) && text == "ABCDEFGHIJKLMNOP");
+
+        CHECK(IsPrintableServerText(""));
+        CHECK(IsPrintableServerText(" ~"));
+        CHECK(IsPrintableServerText("ABCDEFGHIJKLMNOPQRSTUVWXYZ"));
+        for (std::size_t position = 0; position < 20; position++) {
+            for (unsigned char bad : { 0x00, 0x1F, 0x7F, 0x80, 0xFF }) {
+                std::string word(20, 'x');
+                word[position] = static_cast<char>(bad);
+                CHECK(!IsPrintableServerText(word));
+            }
+        }
+
+        // Names from clients are sanitized on the host, the host's are taken as sent.
+        NetworkPacket armor;
+        MakeUpdate(SYNC_ARMOR, armor);
+        armor.stateUpdate.armor.armor = "ITAR\x01_MIL_L";
+        std::vector<std::uint8_t> bytes;
+        NetworkPacket decoded;
+        CHECK(Encode(armor, bytes));
+        CHECK(Decode(bytes, decoded, PacketDecodeMode::Server));
+        CHECK(decoded.stateUpdate.armor.armor == "ITAR_MIL_L");
+        CHECK(Decode(bytes, decoded, PacketDecodeMode::Client));
+        CHECK(decoded.stateUpdate.armor.armor == "ITAR\x01_MIL_L");
+
+        armor.stateUpdate.armor.armor = "\x01\x02";
+        CHECK(Encode(armor, bytes));
+        CHECK(!Decode(bytes, decoded, PacketDecodeMode::Server));
+    }
+}
+
+int main() {
+    TestRoundTrips();
+    TestNotSentAsStateUpdates();
+    TestTruncatedPackets();
+    TestOversizedPackets();
+    TestInvalidHeaders();
+    TestSnapshotDeltas();
+    TestSnapshotSequences();
+    TestSanitize();
+
+    std::fprintf(stderr, "%d checks, %d failed\n", Checks, Failures);
+    return Failures == 0 ? 0 : 1;
+}
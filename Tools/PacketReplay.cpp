@@ -0,0 +1,264 @@
+// Replays a GothicCoop packet capture (.gcap) through the decoder and through
+// candidate encoders, and reports decode rate, size per update type and a
+// bytes-per-second timeline.
+// Usage: packet_replay <capture.gcap> [--passes N] [--encoder NAME] [--no-timeline]
+#include "NetCore/NetCore.h"
+#include "PacketCapture.cpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace NetCore;
+
+namespace {
+    typedef bool (*EncodeFn)(const NetworkPacket& packet, std::vector<std::uint8_t>& out, std::string& error);
+
+    struct CandidateEncoder {
+        const char* name;
+        EncodeFn encode;
+    };
+
+    // Register alternative wire formats here to compare them against the
+    // current serializer on the same capture.
+    const CandidateEncoder kCandidateEncoders[] = {
+        { "baseline", &SerializeNetworkPacket },
+    };
+
+    struct MappedFile {
+        const std::uint8_t* data = nullptr;
+        std::size_t size = 0;
+
+        bool Open(const char* path) {
+            int fd = open(path, O_RDONLY);
+            if (fd < 0) {
+                return false;
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+                close(fd);
+                return false;
+            }
+            void* mapping = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (mapping == MAP_FAILED) {
+                return false;
+            }
+            data = static_cast<const std::uint8_t*>(mapping);
+            size = static_cast<std::size_t>(st.st_size);
+            return true;
+        }
+
+        ~MappedFile() {
+            if (data) {
+                munmap(const_cast<std::uint8_t*>(data), size);
+            }
+        }
+    };
+
+    struct SizeStats {
+        std::size_t count = 0;
+        std::size_t bytes = 0;
+        std::map<std::string, std::size_t> encodedBytes;
+    };
+
+    std::string PacketKey(const NetworkPacket& packet) {
+        switch (packet.type) {
+        case PacketType::JoinGame: return "JoinGame";
+        case PacketType::PlayerDisconnect: return "PlayerDisconnect";
+        case PacketType::StateSnapshot: return "StateSnapshot";
+        case PacketType::SnapshotAck: return "SnapshotAck";
+        case PacketType::NpcAuthority: return "NpcAuthority";
+        case PacketType::PlayerStateUpdate: break;
+        }
+
+        static const char* kUpdateNames[] = {
+            "SYNC_POS", "SYNC_HEADING", "SYNC_ANIMATION", "SYNC_WEAPON_MODE", "INIT_NPC", "DESTROY_NPC",
+            "SYNC_ATTACKS", "SYNC_ARMOR", "SYNC_WEAPONS", "SYNC_HP", "SYNC_TIME", "SYNC_HAND",
+            "SYNC_MAGIC_SETUP", "SYNC_SPELL_CAST", "SYNC_REVIVED", "SYNC_PROTECTIONS", "SYNC_PLAYER_NAME",
+            "PLAYER_DISCONNECT", "SYNC_TALENTS", "SYNC_BODYSTATE", "SYNC_OVERLAYS", "SYNC_DROPITEM", "SYNC_TAKEITEM",
+            "RELEASE_NPC",
+        };
+        auto index = static_cast<std::size_t>(packet.stateUpdate.updateType);
+        if (index < sizeof(kUpdateNames) / sizeof(kUpdateNames[0])) {
+            return kUpdateNames[index];
+        }
+        return "UPDATE_" + std::to_string(index);
+    }
+
+    PacketDecodeMode DecodeModeFor(const CaptureFileHeader& header, CaptureDirection direction) {
+        bool fromClient = (header.role == static_cast<std::uint8_t>(CaptureRole::Host)) == (direction == CaptureDirection::Inbound);
+        return fromClient ? PacketDecodeMode::Server : PacketDecodeMode::Client;
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    int passes = 20;
+    std::string onlyEncoder;
+    bool timeline = true;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--passes" && i + 1 < argc) {
+            passes = std::atoi(argv[++i]);
+        }
+        else if (arg == "--encoder" && i + 1 < argc) {
+            onlyEncoder = argv[++i];
+        }
+        else if (arg == "--no-timeline") {
+            timeline = false;
+        }
+        else if (!path) {
+            path = argv[i];
+        }
+        else {
+            std::fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (!path) {
+        std::fprintf(stderr, "Usage: %s <capture.gcap> [--passes N] [--encoder NAME] [--no-timeline]\n", argv[0]);
+        return 2;
+    }
+    if (passes < 1) {
+        passes = 1;
+    }
+
+    MappedFile file;
+    if (!file.Open(path)) {
+        std::fprintf(stderr, "Unable to map %s\n", path);
+        return 1;
+    }
+
+    PacketCaptureReader reader(file.data, file.size);
+    CaptureFileHeader header;
+    std::string error;
+    if (!reader.ReadHeader(header, error)) {
+        std::fprintf(stderr, "%s: %s\n", path, error.c_str());
+        return 1;
+    }
+    if (header.packetVersion != kNetworkPacketVersion) {
+        std::fprintf(stderr, "Warning: capture uses packet version %u, decoder expects %u.\n",
+            header.packetVersion, kNetworkPacketVersion);
+    }
+
+    std::vector<CandidateEncoder> encoders;
+    for (const auto& encoder : kCandidateEncoders) {
+        if (onlyEncoder.empty() || onlyEncoder == encoder.name) {
+            encoders.push_back(encoder);
+        }
+    }
+    if (encoders.empty()) {
+        std::fprintf(stderr, "Unknown encoder: %s\n", onlyEncoder.c_str());
+        return 2;
+    }
+
+    // Pass 1: sizes, re-encoding and timeline.
+    std::map<std::string, SizeStats> sizes;
+    std::map<std::uint64_t, std::size_t> inboundPerSecond;
+    std::map<std::uint64_t, std::size_t> outboundPerSecond;
+    std::size_t records = 0;
+    std::size_t failures = 0;
+    std::map<std::string, std::size_t> failureReasons;
+    std::uint64_t lastTimestampUs = 0;
+
+    CaptureRecordView record;
+    NetworkPacket packet;
+    std::vector<std::uint8_t> encoded;
+    while (reader.Next(record)) {
+        records++;
+        lastTimestampUs = record.timestampUs;
+        auto& timelineBucket = record.direction == CaptureDirection::Inbound ? inboundPerSecond : outboundPerSecond;
+        timelineBucket[record.timestampUs / 1000000] += record.length;
+
+        if (!DeserializeNetworkPacket(record.data, record.length, packet, error, DecodeModeFor(header, record.direction))) {
+            failures++;
+            failureReasons[error]++;
+            continue;
+        }
+
+        auto& stats = sizes[PacketKey(packet)];
+        stats.count++;
+        stats.bytes += record.length;
+        for (const auto& encoder : encoders) {
+            // Re-encode as the original sender would have.
+            if (encoder.encode(packet, encoded, error)) {
+                stats.encodedBytes[encoder.name] += encoded.size();
+            }
+        }
+    }
+    if (reader.Truncated()) {
+        std::fprintf(stderr, "Warning: capture ends in a truncated record.\n");
+    }
+
+    // Pass 2: decode rate over the whole capture.
+    using Clock = std::chrono::steady_clock;
+    std::size_t decoded = 0;
+    auto start = Clock::now();
+    for (int pass = 0; pass < passes; pass++) {
+        reader.Rewind();
+        while (reader.Next(record)) {
+            if (DeserializeNetworkPacket(record.data, record.length, packet, error, DecodeModeFor(header, record.direction))) {
+                decoded++;
+            }
+        }
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::printf("capture: %s\n", path);
+    std::printf("role: %s, packet version %u, %zu records over %.1f s\n",
+        header.role == static_cast<std::uint8_t>(CaptureRole::Host) ? "host" : "client",
+        header.packetVersion, records, lastTimestampUs / 1000000.0);
+    std::printf("decode: %zu ok, %zu failed, %.0f packets/s (%d passes)\n",
+        records - failures, failures, elapsed > 0.0 ? decoded / elapsed : 0.0, passes);
+    for (const auto& reason : failureReasons) {
+        std::printf("  failed: %-40s %zu\n", reason.first.c_str(), reason.second);
+    }
+
+    std::printf("\n%-18s %8s %12s %8s", "type", "count", "wire bytes", "avg");
+    for (const auto& encoder : encoders) {
+        std::printf(" %14s", encoder.name);
+    }
+    std::printf("\n");
+    std::size_t totalBytes = 0;
+    std::map<std::string, std::size_t> totalEncoded;
+    for (const auto& entry : sizes) {
+        const auto& stats = entry.second;
+        totalBytes += stats.bytes;
+        std::printf("%-18s %8zu %12zu %8.1f", entry.first.c_str(), stats.count, stats.bytes,
+            static_cast<double>(stats.bytes) / stats.count);
+        for (const auto& encoder : encoders) {
+            auto it = stats.encodedBytes.find(encoder.name);
+            std::size_t bytes = it == stats.encodedBytes.end() ? 0 : it->second;
+            totalEncoded[encoder.name] += bytes;
+            std::printf(" %14zu", bytes);
+        }
+        std::printf("\n");
+    }
+    std::printf("%-18s %8s %12zu %8s", "total", "", totalBytes, "");
+    for (const auto& encoder : encoders) {
+        std::printf(" %14zu", totalEncoded[encoder.name]);
+    }
+    std::printf("\n");
+
+    if (timeline) {
+        std::uint64_t lastSecond = lastTimestampUs / 1000000;
+        std::printf("\n%-8s %12s %12s\n", "second", "in B/s", "out B/s");
+        for (std::uint64_t second = 0; second <= lastSecond; second++) {
+            auto in = inboundPerSecond.count(second) ? inboundPerSecond[second] : 0;
+            auto out = outboundPerSecond.count(second) ? outboundPerSecond[second] : 0;
+            std::printf("%-8llu %12zu %12zu\n", static_cast<unsigned long long>(second), in, out);
+        }
+    }
+
+    return 0;
+}
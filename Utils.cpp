@@ -1,6 +1,11 @@
 // Supported with union (c) 2020 Union team
 // Union SOURCE file
 
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 namespace GOTHIC_ENGINE {
 	
 
@@ -10,6 +15,18 @@ namespace GOTHIC_ENGINE {
         return a + (b - a) * t;
     }
 
+    float GetVec3LengthApprox(const zVEC3& vec) {
+    #ifdef __G1A
+            return vec.Length();
+    #else
+            return vec.LengthApprox();
+    #endif
+    }
+
+    float GetVec3LengthSquared(const zVEC3& vec) {
+        return vec.n[0] * vec.n[0] + vec.n[1] * vec.n[1] + vec.n[2] * vec.n[2];
+    }
+
     // min max limit for a float variable
     void zClamp(float& value, float bl, float bh) {
         if (value < bl)
@@ -18,169 +35,155 @@ namespace GOTHIC_ENGINE {
             value = bh;
     }
 
-	Common::Map<zSTRING, int> MdsHumansMap;
-
-	void CheckMdsMap() {
-		static int check = 0;
-		if (!check) {
-			check = 1;
-			MdsHumansMap.Insert("HUMANS.MDS", 0);
-			MdsHumansMap.Insert("HUMANS_RELAXED.MDS", 1);
-			MdsHumansMap.Insert("HUMANS_1HST2.MDS", 2);
-			MdsHumansMap.Insert("HUMANS_2HST2.MDS", 3);
-			MdsHumansMap.Insert("HUMANS_BOWT2.MDS", 4);
-			MdsHumansMap.Insert("HUMANS_CBOWT2.MDS", 5);
-			MdsHumansMap.Insert("HUMANS_MILITIA.MDS", 6);
-			MdsHumansMap.Insert("HUMANS_1HST3.MDS", 7);
-			MdsHumansMap.Insert("HUMANS_2HST3.MDS", 8);
-			MdsHumansMap.Insert("HUMANS_ARROGANCE.MDS", 9);
-			MdsHumansMap.Insert("HUMANS_1HST1.MDS", 10);
-			MdsHumansMap.Insert("HUMANS_2HST1.MDS", 11);
-			MdsHumansMap.Insert("HUMANS_BOWT1.MDS", 12);
-			MdsHumansMap.Insert("HUMANS_CBOWT1.MDS", 13);
-			MdsHumansMap.Insert("HUMANS_SPST2.MDS", 14);
-			MdsHumansMap.Insert("HUMANS_ACROBATIC.MDS", 15);
-			MdsHumansMap.Insert("HUMANS_MAGESPRINT.MDS", 16);
-			MdsHumansMap.Insert("HUMANS_TIRED.MDS", 17);
-			MdsHumansMap.Insert("HUMANS_MAGE.MDS", 18);
-			MdsHumansMap.Insert("HUMANS_SKELETON.MDS", 19);
-			MdsHumansMap.Insert("HUMANS_SKELETON_FLY.MDS", 20);
-			MdsHumansMap.Insert("HUMANS_BABE.MDS", 21);
-			MdsHumansMap.Insert("SHIELD.MDS", 22);
-			MdsHumansMap.Insert("HUMANS_PIRATE.MDS", 23);
-			MdsHumansMap.Insert("HUMANS_ARR.MDS", 24);
-			MdsHumansMap.Insert("SHIELD_ST1.MDS", 25);
-			MdsHumansMap.Insert("HUMANS_SPST1.MDS", 26);
-			MdsHumansMap.Insert("HUMANS_TRD.MDS", 27);
-			MdsHumansMap.Insert("HUMANS_SIT_EAT.MDS", 28);
-			MdsHumansMap.Insert("HUMANS_SIT_DRINK.MDS", 29);
-			MdsHumansMap.Insert("SHIELD_ST2.MDS", 30);
-			MdsHumansMap.Insert("HUMANS_REL.MDS", 31);
-			MdsHumansMap.Insert("HUMANS_AXEST2.MDS", 32);
-			MdsHumansMap.Insert("HUMANS_NEWTORCH.MDS", 33);
-
-		}
-	}
+	// Overlay MDS files known to every client. The position in this table is the
+	// overlay's id on the wire, so entries may only be appended.
+	static const char* const MdsOverlayNames[] = {
+		"HUMANS.MDS",
+		"HUMANS_RELAXED.MDS",
+		"HUMANS_1HST2.MDS",
+		"HUMANS_2HST2.MDS",
+		"HUMANS_BOWT2.MDS",
+		"HUMANS_CBOWT2.MDS",
+		"HUMANS_MILITIA.MDS",
+		"HUMANS_1HST3.MDS",
+		"HUMANS_2HST3.MDS",
+		"HUMANS_ARROGANCE.MDS",
+		"HUMANS_1HST1.MDS",
+		"HUMANS_2HST1.MDS",
+		"HUMANS_BOWT1.MDS",
+		"HUMANS_CBOWT1.MDS",
+		"HUMANS_SPST2.MDS",
+		"HUMANS_ACROBATIC.MDS",
+		"HUMANS_MAGESPRINT.MDS",
+		"HUMANS_TIRED.MDS",
+		"HUMANS_MAGE.MDS",
+		"HUMANS_SKELETON.MDS",
+		"HUMANS_SKELETON_FLY.MDS",
+		"HUMANS_BABE.MDS",
+		"SHIELD.MDS",
+		"HUMANS_PIRATE.MDS",
+		"HUMANS_ARR.MDS",
+		"SHIELD_ST1.MDS",
+		"HUMANS_SPST1.MDS",
+		"HUMANS_TRD.MDS",
+		"HUMANS_SIT_EAT.MDS",
+		"HUMANS_SIT_DRINK.MDS",
+		"SHIELD_ST2.MDS",
+		"HUMANS_REL.MDS",
+		"HUMANS_AXEST2.MDS",
+		"HUMANS_NEWTORCH.MDS",
+	};
+	const int MdsOverlayCount = static_cast<int>(sizeof(MdsOverlayNames) / sizeof(MdsOverlayNames[0]));
+	static_assert(sizeof(MdsOverlayNames) / sizeof(MdsOverlayNames[0]) <= kMaxOverlayCount, "Overlay ids on the wire must stay below kMaxOverlayCount.");
 
 	int GetMdsIndex(zSTRING mds) {
-		CheckMdsMap();
-		mds.Upper();
-
-		auto arr = MdsHumansMap.GetArray();
-		const int count = static_cast<int>(arr.GetNum());
-		for (int i = 0; i < count; i++) {
-			if (auto pair = arr.GetSafe(i)) {
-				if (mds == pair->GetKey()) {
-					return pair->GetValue();
-				}
+		static std::unordered_map<std::string, int> indexByName;
+		if (indexByName.empty()) {
+			for (int i = 0; i < MdsOverlayCount; i++) {
+				indexByName[MdsOverlayNames[i]] = i;
 			}
 		}
 
-
-		//cmd << "GetMdsIndex invalid " << mds << endl;
-
-		return -1;
+		mds.Upper();
+		auto found = indexByName.find(mds.ToChar());
+		return found != indexByName.end() ? found->second : -1;
 	}
 
 	zSTRING GetMdsByIndex(int index) {
-		CheckMdsMap();
-		auto arr = MdsHumansMap.GetArray();
-		const int count = static_cast<int>(arr.GetNum());
-		for (int i = 0; i < count; i++) {
-			if (auto pair = arr.GetSafe(i)) {
-				if (index == pair->GetValue()) {
-					return pair->GetKey();
-				}
-			}
+		if (index < 0 || index >= MdsOverlayCount) {
+			return "";
 		}
-
-		return "";
+		return MdsOverlayNames[index];
 	}
 
-	zCArray<int> GetNpcMds(oCNpc* npc) {
-		zCArray<int> arr;
+	// Known overlays applied to the NPC's model, in the order they are stacked.
+	// HUMANS.MDS is the base model and left out.
+	std::vector<std::uint8_t> GetNpcOverlays(oCNpc* npc) {
+		std::vector<std::uint8_t> overlays;
 		if (npc && npc->GetModel()) {
-			auto proto = npc->GetModel()->modelProtoList;
+			auto& proto = npc->GetModel()->modelProtoList;
 			for (int i = 0; i < proto.GetNumInList(); i++) {
 				if (auto protoInst = proto.GetSafe(i)) {
-					arr.Insert(GetMdsIndex(protoInst->modelProtoFileName));
+					int index = GetMdsIndex(protoInst->modelProtoFileName);
+					if (index > 0) {
+						overlays.push_back(static_cast<std::uint8_t>(index));
+					}
 				}
 			}
 		}
-		return arr;
+		return overlays;
 	}
 
-	void oCNpc::ApplyOverlaysNpc(oCNpc* npc) {
-		if (!npc) return;
-
-		zCArray<int> npcMdsList = GetNpcMds(npc);
-		ApplyOverlaysArray(npcMdsList);
-	}
+	// Overlays only change when the model's prototype list does, so the list is
+	// recomputed only when the prototypes differ from the ones it was computed for.
+	class OverlayTracker {
+	public:
+		const std::vector<std::uint8_t>& Get(oCNpc* npc) {
+			if (!npc || !npc->GetModel()) {
+				protos.clear();
+				overlays.clear();
+				return overlays;
+			}
 
-	void oCNpc::ApplyOverlaysArray(zCArray<int> npcMdsArray) {
-		zCArray<zCModelPrototype*> protoList = GetModel()->modelProtoList;
-		zCArray<zSTRING> mdsList;
-		for (int i = 0; i < protoList.GetNumInList(); i++) {
-			if (zCModelPrototype* proto = protoList.GetSafe(i)) {
-				if (proto->modelProtoFileName != "HUMANS.MDS") {
-					mdsList.Insert(proto->modelProtoFileName);
+			auto& protoList = npc->GetModel()->modelProtoList;
+			bool changed = protos.size() != static_cast<std::size_t>(protoList.GetNumInList());
+			for (int i = 0; !changed && i < protoList.GetNumInList(); i++) {
+				changed = protos[i] != protoList.GetSafe(i);
+			}
+			if (changed) {
+				protos.clear();
+				for (int i = 0; i < protoList.GetNumInList(); i++) {
+					protos.push_back(protoList.GetSafe(i));
 				}
+				overlays = GetNpcOverlays(npc);
 			}
+			return overlays;
 		}
 
-		for (int i = 0; i < mdsList.GetNumInList(); i++) {
-			zSTRING mds = mdsList.GetSafe(i);
-			this->RemoveOverlayMds(mds);
+		void Reset() {
+			protos.clear();
+			overlays.clear();
 		}
 
-		for (int i = 0; i < npcMdsArray.GetNumInList(); i++) {
-			int index = npcMdsArray.GetSafe(i);
-			zSTRING mds = GetMdsByIndex(index);
+	private:
+		std::vector<zCModelPrototype*> protos;
+		std::vector<std::uint8_t> overlays;
+	};
 
-			if (!mds.IsEmpty() && mds != "HUMANS.MDS") {
-				this->ApplyOverlayMds(mds);
-			}
-		}
+	void oCNpc::ApplyOverlaysNpc(oCNpc* npc) {
+		if (!npc) return;
+
+		auto overlays = GetNpcOverlays(npc);
+		ApplyOverlays(overlays.data(), static_cast<int>(overlays.size()));
 	}
 
-	int oCNpc::CompareOverlaysMds(oCNpc* npc) {
-		if (!npc) return 0;
-		zCArray<int> npcMdsList = GetNpcMds(npc);
-		zCArray<int> npcMdsListMy = GetNpcMds(this);
-		if (npcMdsListMy.GetNumInList() != npcMdsList.GetNumInList()) {
-			return 0;
+	// Overlays override each other by stacking order, so the sender's order is
+	// kept: overlays after the first difference are removed from the top and
+	// the rest applied in order. Each change re-inits the animation controller,
+	// so the common bottom of the stack is left alone.
+	void oCNpc::ApplyOverlays(const unsigned char* overlays, int count) {
+		auto current = GetNpcOverlays(this);
+		std::size_t common = 0;
+		while (common < current.size() && static_cast<int>(common) < count && current[common] == overlays[common]) {
+			common++;
 		}
-		else {
-			for (int i = 0; i < npcMdsListMy.GetNumInList(); i++) {
-				int mdsMy = npcMdsListMy.GetSafe(i);
-				if (!npcMdsList.IsInList(mdsMy)) {
-					return 0;
-				}
-			}
+		if (common == current.size() && static_cast<int>(common) == count) {
+			return;
 		}
 
-
-		return 1;
-	}
-
-	int oCNpc::CompareOverlaysArray(zCArray<int> npcMdsList) {
-
-		zCArray<int> npcMdsListMy = GetNpcMds(this);
-
-		if (npcMdsListMy.GetNumInList() != npcMdsList.GetNumInList()) {
-			return 0;
+		for (std::size_t i = current.size(); i > common; i--) {
+			this->RemoveOverlayMds(MdsOverlayNames[current[i - 1]]);
 		}
-		else {
-			for (int i = 0; i < npcMdsListMy.GetNumInList(); i++) {
-				int mdsMy = npcMdsListMy.GetSafe(i);
-				if (!npcMdsList.IsInList(mdsMy)) {
-					return 0;
-				}
+		for (int i = static_cast<int>(common); i < count; i++) {
+			if (overlays[i] > 0 && overlays[i] < MdsOverlayCount) {
+				this->ApplyOverlayMds(MdsOverlayNames[overlays[i]]);
 			}
 		}
+	}
 
-
-		return 1;
+	int oCNpc::CompareOverlaysMds(oCNpc* npc) {
+		if (!npc) return 0;
+		return GetNpcOverlays(npc) == GetNpcOverlays(this);
 	}
 
 	void oCNpc::RemoveOverlayMds(const zSTRING& mds) {
@@ -226,28 +229,4 @@ namespace GOTHIC_ENGINE {
 		player->GetHomeWorld()->bspTree.bspRoot->CollectVobsInBBox3D(vobList, box);
 		return vobList;
 	}
-
-	ENetPacketFlag PacketFlag(const NetworkPacket& packet)
-	{
-		if (packet.type == PacketType::PlayerStateUpdate) {
-			auto updateType = packet.stateUpdate.updateType;
-			if (updateType == SYNC_POS || updateType == SYNC_HEADING) {
-				return ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT;
-			}
-		}
-
-		return ENET_PACKET_FLAG_RELIABLE;
-	}
-
-	int PacketChannel(const NetworkPacket& packet)
-	{
-		if (packet.type == PacketType::PlayerStateUpdate) {
-			auto updateType = packet.stateUpdate.updateType;
-			if (updateType == SYNC_POS || updateType == SYNC_HEADING) {
-				return 1;
-			}
-		}
-
-		return 0;
-	}
 }
\ No newline at end of file
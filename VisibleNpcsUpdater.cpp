@@ -1,9 +1,16 @@
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <vector>
+
 namespace GOTHIC_ENGINE {
     void UpdateVisibleNpc() {
         PluginState = "UpdateVisibleNpc";
 
-        if (ServerThread) {
-            auto npcs = GetVisibleNpcs();
+        // The host broadcasts every NPC nobody else took; with distributed
+        // authority clients broadcast the NPCs they were handed.
+        if ((ServerThread || ClientThread) && player) {
+            auto npcs = UpdateNpcAuthority(GetVisibleNpcs());
             std::map<string, LocalNpc*> updatedBroadcastNpcs;
 
             for each (auto npc in npcs)
@@ -24,4 +31,98 @@ namespace GOTHIC_ENGINE {
             BroadcastNpcs = updatedBroadcastNpcs;
         }
     }
-}
\ No newline at end of file
+
+    static bool IsBroadcastNpcInCombat(LocalNpc* localNpc) {
+        auto npc = localNpc->npc;
+        return npc && (npc->GetWeaponMode() != NPC_WEAPON_NONE || !localNpc->hitsToSync.empty());
+    }
+
+    // How often a broadcast NPC is sampled and sent, by distance to
+    // the nearest player. Anything in combat stays at the near rate.
+    int GetBroadcastLodIntervalMs(LocalNpc* localNpc) {
+        auto npc = localNpc->npc;
+        if (!npc || localNpc->broadcastInCombat) {
+            return LodNearIntervalMs;
+        }
+
+        auto npcPosition = npc->GetPositionWorld();
+        float nearest = player ? player->GetPositionWorld().Distance(npcPosition) : FLT_MAX;
+        for (auto& playerNpc : PlayerNpcs) {
+            if (!playerNpc.first) {
+                continue;
+            }
+            float dist = playerNpc.first->GetPositionWorld().Distance(npcPosition);
+            if (dist < nearest) {
+                nearest = dist;
+            }
+        }
+
+        if (nearest <= LodNearDistance) {
+            return LodNearIntervalMs;
+        }
+        if (nearest <= LodFarDistance) {
+            return LodMidIntervalMs;
+        }
+        return LodFarIntervalMs;
+    }
+
+    // Spreads broadcast NPC sampling over frames. An NPC becomes due after its
+    // LOD interval, but never more often than the network tick. Due NPCs are
+    // pulsed until the per-frame budget is spent, ordered by how late they are
+    // relative to their interval. Combat counts as two intervals late, so an
+    // NPC that keeps missing the budget eventually overtakes the fights.
+    // Whatever is left over runs in the next frames, and at least one NPC is
+    // pulsed every frame.
+    void PulseBroadcastNpcs() {
+        PluginState = "PulseBroadcastNpcs";
+        BroadcastPulsesLastFrame = 0;
+        BroadcastMaxStalenessMs = 0;
+
+        struct DueNpc {
+            LocalNpc* localNpc;
+            float priority;
+        };
+        std::vector<DueNpc> due;
+        for (auto& p : BroadcastNpcs) {
+            auto localNpc = p.second;
+            if (localNpc->lastBroadcastPulseMs > 0 && CurrentMs - localNpc->lastBroadcastPulseMs > BroadcastMaxStalenessMs) {
+                BroadcastMaxStalenessMs = CurrentMs - localNpc->lastBroadcastPulseMs;
+            }
+            if (CurrentMs < localNpc->nextBroadcastPulseMs) {
+                continue;
+            }
+
+            localNpc->broadcastInCombat = IsBroadcastNpcInCombat(localNpc);
+            float overdueMs = static_cast<float>(CurrentMs - localNpc->nextBroadcastPulseMs);
+            long long intervalMs = localNpc->nextBroadcastPulseMs - localNpc->lastBroadcastPulseMs;
+            if (intervalMs < 1) {
+                intervalMs = 1;
+            }
+            due.push_back({ localNpc, (localNpc->broadcastInCombat ? 2.0f : 0.0f) + overdueMs / intervalMs });
+        }
+        if (due.empty()) {
+            return;
+        }
+
+        std::sort(due.begin(), due.end(), [](const DueNpc& a, const DueNpc& b) {
+            return a.priority > b.priority;
+        });
+
+        long long tickMs = 1000 / NetworkTickRate;
+        auto start = std::chrono::steady_clock::now();
+        for (auto& entry : due) {
+            auto localNpc = entry.localNpc;
+            localNpc->Pulse();
+            localNpc->PackUpdate();
+            localNpc->lastBroadcastPulseMs = CurrentMs;
+            long long intervalMs = GetBroadcastLodIntervalMs(localNpc);
+            localNpc->nextBroadcastPulseMs = CurrentMs + (intervalMs > tickMs ? intervalMs : tickMs);
+            BroadcastPulsesLastFrame++;
+
+            auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+            if (elapsedUs >= PulseBudgetUs) {
+                break;
+            }
+        }
+    }
+}
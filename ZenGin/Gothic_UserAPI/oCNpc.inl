@@ -6,6 +6,5 @@
 void ApplyOverlayMds(const zSTRING& mds);
 void RemoveOverlayMds(const zSTRING& mds);
 void oCNpc::ApplyOverlaysNpc(oCNpc* npc);
-void oCNpc::ApplyOverlaysArray(zCArray<int> npcMdsArray);
-int oCNpc::CompareOverlaysMds(oCNpc* npc);
-int oCNpc::CompareOverlaysArray(zCArray<int> npcMdsList);
\ No newline at end of file
+void oCNpc::ApplyOverlays(const unsigned char* overlays, int count);
+int oCNpc::CompareOverlaysMds(oCNpc* npc);
\ No newline at end of file